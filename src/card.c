@@ -93,7 +93,7 @@ cartaT *split_matricole(cartaT **mazzo_head) {
  * @param card card to make a copy of
  * @return cartaT* card copy
  */
-cartaT *duplicate_carta(cartaT *card) {
+cartaT *duplicate_carta(const cartaT *card) {
 	cartaT *copy_card = (cartaT*)malloc_checked(sizeof(cartaT));
 
 	*copy_card = *card; // copy the whole struct
@@ -7,7 +7,7 @@
 void clear_cards(cartaT *head);
 cartaT *shuffle_cards(cartaT *cards);
 cartaT *split_matricole(cartaT **mazzo_head);
-cartaT *duplicate_carta(cartaT *card);
+cartaT *duplicate_carta(const cartaT *card);
 cartaT *pop_card(cartaT **head_ptr);
 void push_card(cartaT **head_ptr, cartaT *card);
 void unlink_card(cartaT **head_ptr, cartaT *card);
@@ -0,0 +1,144 @@
+#include <string.h>
+#include "catalog.h"
+#include "structs.h"
+#include "utils.h"
+
+/**
+ * @brief initialize saves catalog internal fields, must always be called before using the catalog
+ * 
+ * @param catalog pointer to the catalog
+ */
+void init_catalog(saves_catalogT *catalog) {
+	catalog->n_entries = catalog->entries_capacity = 0;
+	catalog->entries = NULL;
+	catalog->n_slots = CATALOG_MIN_SLOTS;
+	catalog->slots = (int*)malloc_checked(catalog->n_slots*sizeof(int));
+	for (int i = 0; i < catalog->n_slots; i++)
+		catalog->slots[i] = -1;
+	catalog->mru_head = catalog->mru_tail = -1;
+}
+
+/**
+ * @brief free up memory allocated by the saves catalog, must always be called after finished using the catalog
+ * 
+ * @param catalog pointer to the catalog
+ */
+void clear_catalog(saves_catalogT *catalog) {
+	for (int i = 0; i < catalog->n_entries; i++)
+		free_wrap(catalog->entries[i].name);
+	free_wrap(catalog->entries);
+	free_wrap(catalog->slots);
+}
+
+/**
+ * @brief finds the hash index slot of a save name (linear probing)
+ * 
+ * @param catalog pointer to the catalog
+ * @param save_name save name to look for
+ * @return int slot containing the save name entry, or the empty slot where it should be inserted
+ */
+int catalog_slot(saves_catalogT *catalog, const char *save_name) {
+	int mask = catalog->n_slots - 1;
+	int slot = hash_string(save_name) & mask;
+
+	while (catalog->slots[slot] != -1 && strcmp(catalog->entries[catalog->slots[slot]].name, save_name))
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+/**
+ * @brief doubles the hash index size re-inserting every entry
+ * 
+ * @param catalog pointer to the catalog
+ */
+void catalog_grow_slots(saves_catalogT *catalog) {
+	free_wrap(catalog->slots);
+	catalog->n_slots *= 2;
+	catalog->slots = (int*)malloc_checked(catalog->n_slots*sizeof(int));
+	for (int i = 0; i < catalog->n_slots; i++)
+		catalog->slots[i] = -1;
+	for (int i = 0; i < catalog->n_entries; i++)
+		catalog->slots[catalog_slot(catalog, catalog->entries[i].name)] = i;
+}
+
+/**
+ * @brief removes an entry from the MRU list
+ * 
+ * @param catalog pointer to the catalog
+ * @param idx index of the entry
+ */
+void catalog_unlink(saves_catalogT *catalog, int idx) {
+	save_entryT *entry = &catalog->entries[idx];
+
+	if (entry->prev != -1)
+		catalog->entries[entry->prev].next = entry->next;
+	else
+		catalog->mru_head = entry->next;
+	if (entry->next != -1)
+		catalog->entries[entry->next].prev = entry->prev;
+	else
+		catalog->mru_tail = entry->prev;
+}
+
+/**
+ * @brief inserts an entry at the head of the MRU list
+ * 
+ * @param catalog pointer to the catalog
+ * @param idx index of the entry
+ */
+void catalog_push_front(saves_catalogT *catalog, int idx) {
+	save_entryT *entry = &catalog->entries[idx];
+
+	entry->prev = -1;
+	entry->next = catalog->mru_head;
+	if (catalog->mru_head != -1)
+		catalog->entries[catalog->mru_head].prev = idx;
+	else
+		catalog->mru_tail = idx;
+	catalog->mru_head = idx;
+}
+
+/**
+ * @brief registers an access to a save, adding it to the catalog if not present and making it the most recently used one.
+ * each call corresponds to one record of the catalog file.
+ * 
+ * @param catalog pointer to the catalog
+ * @param save_name accessed save name
+ * @param timestamp access time
+ */
+void catalog_touch(saves_catalogT *catalog, const char *save_name, long long timestamp) {
+	int idx, slot = catalog_slot(catalog, save_name);
+
+	idx = catalog->slots[slot];
+	if (idx != -1) {
+		catalog_unlink(catalog, idx);
+	} else {
+		if (catalog->n_entries == catalog->entries_capacity) {
+			catalog->entries_capacity = catalog->entries_capacity == 0 ? CATALOG_MIN_SLOTS/2 : catalog->entries_capacity*2;
+			catalog->entries = (save_entryT*)realloc_checked(catalog->entries, catalog->entries_capacity*sizeof(save_entryT));
+		}
+		idx = catalog->n_entries++;
+		catalog->entries[idx].name = strdup_checked(save_name);
+		catalog->slots[slot] = idx;
+		if (2*catalog->n_entries > catalog->n_slots) // keep load factor under 1/2
+			catalog_grow_slots(catalog);
+	}
+	catalog->entries[idx].last_access = timestamp;
+	catalog_push_front(catalog, idx);
+}
+
+/**
+ * @brief collects the most recently used saves, walking only the head of the MRU list
+ * 
+ * @param catalog pointer to the catalog
+ * @param indexes array receiving the indexes of the entries, from the most recently used (out parameter)
+ * @param max_count maximum number of entries to collect
+ * @return int number of collected entries
+ */
+int catalog_most_recent(saves_catalogT *catalog, int *indexes, int max_count) {
+	int count = 0;
+
+	for (int idx = catalog->mru_head; idx != -1 && count < max_count; idx = catalog->entries[idx].next)
+		indexes[count++] = idx;
+	return count;
+}
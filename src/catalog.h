@@ -0,0 +1,11 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include "types.h"
+
+void init_catalog(saves_catalogT *catalog);
+void clear_catalog(saves_catalogT *catalog);
+void catalog_touch(saves_catalogT *catalog, const char *save_name, long long timestamp);
+int catalog_most_recent(saves_catalogT *catalog, int *indexes, int max_count);
+
+#endif // CATALOG_H
\ No newline at end of file
@@ -0,0 +1,209 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "checkpoint.h"
+#include "structs.h"
+#include "card.h"
+#include "utils.h"
+
+/**
+ * @brief collects pointers to the heads of every cards list of the game, in checkpoint zone order
+ * 
+ * @param game_ctx current game state
+ * @param ring checkpoint ring (provides players in seat order)
+ * @param zones array of CHECKPOINT_ZONES pointers to list heads (out parameter)
+ * @return int number of zones actually used by this game
+ */
+int collect_zones(game_contextT *game_ctx, checkpoint_ringT *ring, cartaT **zones[]) {
+	int n_zones = 0;
+
+	for (int seat = 0; seat < ring->n_seats; seat++) {
+		zones[n_zones++] = &ring->seats[seat]->carte;
+		zones[n_zones++] = &ring->seats[seat]->aula;
+		zones[n_zones++] = &ring->seats[seat]->bonus_malus;
+	}
+	zones[n_zones++] = &game_ctx->mazzo_pesca;
+	zones[n_zones++] = &game_ctx->mazzo_scarti;
+	zones[n_zones++] = &game_ctx->aula_studio;
+
+	return n_zones;
+}
+
+/**
+ * @brief compares two card pointers by address, used for sorting and searching the ring cards table
+ * 
+ * @param first pointer to first card pointer
+ * @param second pointer to second card pointer
+ * @return int comparison result as expected by qsort and bsearch
+ */
+int compare_card_addresses(const void *first, const void *second) {
+	uintptr_t a = (uintptr_t)*(cartaT* const*)first, b = (uintptr_t)*(cartaT* const*)second;
+	return (a > b) - (a < b);
+}
+
+/**
+ * @brief creates a checkpoint ring for the current game, building the table of every card and the players seats
+ * 
+ * @param game_ctx current game state
+ * @return checkpoint_ringT* newly created checkpoint ring
+ */
+checkpoint_ringT *new_checkpoint_ring(game_contextT *game_ctx) {
+	cartaT **zones[CHECKPOINT_ZONES];
+	int n_zones, idx = 0;
+	giocatoreT *player = game_ctx->curr_player;
+	player_statsT *stats;
+	unsigned short *pool;
+	checkpoint_ringT *ring = (checkpoint_ringT*)calloc_checked(ONE_ELEMENT, sizeof(checkpoint_ringT));
+
+	ring->n_seats = game_ctx->n_players;
+	for (int seat = 0; seat < ring->n_seats; seat++, player = player->next) {
+		ring->seats[seat] = player;
+		// stats list isn't necessarily aligned with players list, match them by name
+		stats = game_ctx->curr_stats;
+		while (strncmp(stats->name, player->name, GIOCATORE_NAME_LEN))
+			stats = stats->next;
+		ring->seat_stats[seat] = stats;
+	}
+
+	n_zones = collect_zones(game_ctx, ring, zones);
+	for (int zone = 0; zone < n_zones; zone++)
+		ring->n_cards += count_cards(*zones[zone]);
+
+	ring->cards = (cartaT**)malloc_checked(ring->n_cards*sizeof(cartaT*));
+	for (int zone = 0; zone < n_zones; zone++) {
+		for (cartaT *card = *zones[zone]; card != NULL; card = card->next)
+			ring->cards[idx++] = card;
+	}
+	qsort(ring->cards, ring->n_cards, sizeof(cartaT*), compare_card_addresses);
+
+	// a single pool holds the card indexes of every checkpoint
+	pool = (unsigned short*)malloc_checked(CHECKPOINT_RING_SIZE*ring->n_cards*sizeof(unsigned short));
+	for (int i = 0; i < CHECKPOINT_RING_SIZE; i++)
+		ring->checkpoints[i].cards = &pool[i*ring->n_cards];
+
+	ring->head = CHECKPOINT_RING_SIZE-1; // first capture goes to index 0
+	return ring;
+}
+
+/**
+ * @brief frees the checkpoint ring of the game (if any)
+ * 
+ * @param game_ctx current game state
+ */
+void clear_checkpoints(game_contextT *game_ctx) {
+	if (game_ctx->checkpoints != NULL) {
+		free_wrap(game_ctx->checkpoints->checkpoints[0].cards); // pool
+		free_wrap(game_ctx->checkpoints->cards);
+		free_wrap(game_ctx->checkpoints);
+		game_ctx->checkpoints = NULL;
+	}
+}
+
+/**
+ * @brief fills a checkpoint with the current zones contents, stats and round info
+ * 
+ * @param game_ctx current game state
+ * @param ring checkpoint ring
+ * @param checkpoint checkpoint to fill
+ * @return true if the checkpoint was filled
+ * @return false if a card not present in the ring cards table was found
+ */
+bool fill_checkpoint(game_contextT *game_ctx, checkpoint_ringT *ring, checkpointT *checkpoint) {
+	cartaT **zones[CHECKPOINT_ZONES], **found;
+	int n_zones, idx = 0;
+	bool valid = true;
+
+	n_zones = collect_zones(game_ctx, ring, zones);
+	for (int zone = 0; zone < n_zones && valid; zone++) {
+		checkpoint->zone_lengths[zone] = 0;
+		for (cartaT *card = *zones[zone]; card != NULL && valid; card = card->next) {
+			found = (cartaT**)bsearch(&card, ring->cards, ring->n_cards, sizeof(cartaT*), compare_card_addresses);
+			if (found != NULL && idx < ring->n_cards) {
+				checkpoint->cards[idx++] = (unsigned short)(found - ring->cards);
+				checkpoint->zone_lengths[zone]++;
+			} else
+				valid = false;
+		}
+	}
+
+	checkpoint->round_num = game_ctx->round_num;
+	for (int seat = 0; seat < ring->n_seats; seat++) {
+		if (ring->seats[seat] == game_ctx->curr_player)
+			checkpoint->curr_seat = seat;
+		checkpoint->stats[seat] = *ring->seat_stats[seat];
+	}
+
+	return valid;
+}
+
+/**
+ * @brief captures a snapshot of the current game state into the checkpoint ring, overwriting the oldest one when full.
+ * call this at the start of a round.
+ * 
+ * @param game_ctx current game state
+ */
+void capture_checkpoint(game_contextT *game_ctx) {
+	checkpoint_ringT *ring;
+
+	if (game_ctx->checkpoints == NULL)
+		game_ctx->checkpoints = new_checkpoint_ring(game_ctx);
+	ring = game_ctx->checkpoints;
+
+	ring->head = (ring->head + 1) % CHECKPOINT_RING_SIZE;
+	if (!fill_checkpoint(game_ctx, ring, &ring->checkpoints[ring->head])) {
+		// cards table is out of date (shouldn't happen as cards are never created during a game): start a new ring
+		clear_checkpoints(game_ctx);
+		capture_checkpoint(game_ctx);
+	} else if (ring->count < CHECKPOINT_RING_SIZE)
+		ring->count++;
+}
+
+/**
+ * @brief returns how many rounds the game can be rolled back
+ * 
+ * @param game_ctx current game state
+ * @return int maximum rounds_back value accepted by restore_checkpoint
+ */
+int available_rollbacks(game_contextT *game_ctx) {
+	return game_ctx->checkpoints != NULL ? game_ctx->checkpoints->count - 1 : -1;
+}
+
+/**
+ * @brief restores the game state to the start of a previous round relinking every zone, without any allocation.
+ * the restored checkpoint and newer ones are dropped from the ring, as the restored round will capture it again.
+ * 
+ * @param game_ctx current game state
+ * @param rounds_back how many rounds to go back (0 restarts the current round), must not exceed available_rollbacks
+ */
+void restore_checkpoint(game_contextT *game_ctx, int rounds_back) {
+	cartaT **zones[CHECKPOINT_ZONES], **tail_next;
+	int n_zones, idx = 0;
+	player_statsT *stats, *next_stats;
+	checkpoint_ringT *ring = game_ctx->checkpoints;
+	int pos = (ring->head - rounds_back + CHECKPOINT_RING_SIZE) % CHECKPOINT_RING_SIZE;
+	checkpointT *checkpoint = &ring->checkpoints[pos];
+
+	n_zones = collect_zones(game_ctx, ring, zones);
+	for (int zone = 0; zone < n_zones; zone++) {
+		tail_next = zones[zone];
+		for (int i = 0; i < checkpoint->zone_lengths[zone]; i++, idx++) {
+			*tail_next = ring->cards[checkpoint->cards[idx]];
+			tail_next = &(*tail_next)->next;
+		}
+		*tail_next = NULL;
+	}
+
+	for (int seat = 0; seat < ring->n_seats; seat++) {
+		stats = ring->seat_stats[seat];
+		next_stats = stats->next; // keep stats list links
+		*stats = checkpoint->stats[seat];
+		stats->next = next_stats;
+	}
+
+	game_ctx->round_num = checkpoint->round_num;
+	game_ctx->curr_player = ring->seats[checkpoint->curr_seat];
+	game_ctx->curr_stats = ring->seat_stats[checkpoint->curr_seat];
+
+	ring->head = (pos - 1 + CHECKPOINT_RING_SIZE) % CHECKPOINT_RING_SIZE;
+	ring->count -= rounds_back + 1;
+}
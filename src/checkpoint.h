@@ -0,0 +1,11 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "types.h"
+
+void capture_checkpoint(game_contextT *game_ctx);
+int available_rollbacks(game_contextT *game_ctx);
+void restore_checkpoint(game_contextT *game_ctx, int rounds_back);
+void clear_checkpoints(game_contextT *game_ctx);
+
+#endif // CHECKPOINT_H
@@ -15,17 +15,111 @@
 #define SAVE_NAME_LEN 255
 
 #define SAVES_DIRECTORY "saves/"
-#define FILE_SAVES_CACHE "cache.txt"
+#define FILE_SAVES_CACHE "cache.txt" // legacy saves cache, only read to migrate it into the saves catalog
+#define FILE_SAVES_CATALOG "catalog.txt"
+#define FILE_SAVES_RECENT "recent.txt" // most recently used saves of the catalog, read by the load menu
 #define SAVE_PATH_EXTENSION ".sav"
 #define FILE_MAZZO "mazzo.txt"
-#define FILE_LOG "log.txt"
+#define DECK_CACHE_EXTENSION ".bin" // compiled deck files (mazzo.txt -> mazzo.bin), regenerated automatically when the deck changes
+#define FILE_LOG "log.bin" // binary events, rendered as text by tools/log_print.c
+#define LOG_SEGMENT_FORMAT "log.%d.bin" // rotated log files, 1 is the most recent
+#define LOG_COMPRESSED_EXTENSION ".rle" // compressed rotated log files (log.1.bin -> log.1.bin.rle)
 #define FILE_STATS "stats.bin"
+#define FILE_HISTORY "history.bin" // one game_recordT per finished game, aggregated by tools/history_query.c
+#define FILE_STATS_INDEX "stats.idx" // hash index of the stats file records by player name, rebuilt when missing or outdated
+#define REPLAY_PATH_EXTENSION ".rep" // recorded decisions of a game, next to its save
+#ifdef _WIN32
+#define NULL_DEVICE "NUL"
+#else
+#define NULL_DEVICE "/dev/null"
+#endif
+
+#define OPTION_DECK "--mazzo" // command-line option selecting a custom base deck file
+#define OPTION_EXPANSION "--espansione" // command-line option adding an expansion pack to the base deck
+#define OPTION_LOG_LEVEL "--log" // command-line option selecting the log level (dettaglio, turno, sessione, nessuno)
+#define OPTION_LOG_CATEGORIES "--log-categorie" // command-line option selecting the comma separated log categories
+#define OPTION_LOG_MAX_SIZE "--log-dimensione" // command-line option selecting the log size (KB) rotating the log file
+#define OPTION_LOG_SEGMENTS "--log-segmenti" // command-line option selecting the number of rotated log files kept
+#define OPTION_LOG_COMPRESS "--log-comprimi" // command-line option compressing the rotated log files
+#define OPTION_COMPACT "--compatta" // command-line option starting with the compact view of the cards
+#define OPTION_TUI "--tui" // command-line option drawing the screens on the alternate screen, redrawing only changed lines
+#define OPTION_REPLAY "--replay" // command-line option replaying the recorded game of a save headlessly
+
+#define SAVE_HEADER_MAGIC 0x56415355 // "USAV" in little-endian, distinguishes saves with metadata header from legacy ones
+#define SAVE_HEADER_VERSION 1
+#define MAZZO_CACHE_MAGIC 0x4E49424D // "MBIN" in little-endian
+#define MAZZO_CACHE_VERSION 2
+#define DECK_MIN_CAPACITY 16
+#define MAZZO_CACHE_MAX_RECORDS 1000000 // definitions, effects or overrides of a valid cache, keeps its size computable
+#define MAX_DECK_PACKS 8 // base deck + expansion packs
+#define DECK_PACK_NAME_LEN 31
+#define DECK_OVERRIDE_MARK '!' // starts a copy-count override record in deck files
+
+#define SAVE_DATE_FORMAT "%d/%m/%Y %H:%M"
+#define SAVE_DATE_LEN 31
+
+#define SAVES_MENU_COUNT 10 // most recently used saves shown in the load menu
+#define CATALOG_MIN_SLOTS 64
+#define STATS_INDEX_MAGIC 0x49545355 // "USTI" in little-endian
+#define STATS_INDEX_VERSION 2
+#define STATS_INDEX_MIN_SLOTS 64 // slots of the stats index, power of 2 (kept at most half full)
+#define HISTORY_MAGIC 0x54534855 // "UHST" in little-endian
+#define HISTORY_VERSION 1
+#define HISTORY_QUERY_BATCH 4096 // game records read at once by each thread of tools/history_query.c
+#define HISTORY_QUERY_DEFAULT_THREADS 4 // when the processors count isn't available
+#define HISTORY_QUERY_MAX_THREADS 64
+#define HISTORY_FIRST_YEAR 1970 // games per month are counted from january of this year...
+#define HISTORY_MONTHS (150*12) // ...for this many months
+#define EXPORT_BUFFER_SIZE 65536 // output buffered by tools/stats_export.c before each write
+#define EXPORT_ROW_MAX 4096 // longest row written by tools/stats_export.c (escaped names included)
+#define EXPORT_BATCH 4096 // records read at once by tools/stats_export.c
+#define MERGE_BATCH 4096 // records read (and written back) at once by tools/stats_merge.c
+#define MERGE_MIN_SLOTS 1024
+#define STATS_TOP_K 3 // players shown in the leaderboard of each stats metric
+#define STATS_PAGE_SIZE 10 // players whose stats are shown in a page of the stats menu
+#define CATALOG_COMPACT_MIN_SIZE 4096 // below this size (bytes) the catalog file is never compacted
+
+#define LOG_RING_SIZE 4096 // pending log records, must be a power of 2
+#define LOG_WRITER_IDLE_NS 2000000 // writer thread sleep when there are no pending records
+#define LOG_WRITER_SPINS 64 // polls without records the writer thread yields for before sleeping
+#define LOG_KNOWN_CARDS 1024 // card ids declared per session, must be a power of 2
+#define LOG_NO_SEAT 0xFF
+#define LOG_MAGIC 0x474F4C55 // "ULOG" in little-endian, stored in each LOG_EV_START record
+#define LOG_VERSION 1
+#define LOG_PRINTER_MIN_CARDS 64
+#define LOG_DEFAULT_MAX_SIZE 4096 // KB of the log file triggering its rotation, when not chosen from command-line
+#define LOG_DEFAULT_SEGMENTS 4 // rotated log files kept, when not chosen from command-line
+#define LOG_COMPRESSED_MAGIC 0x5A4C4C55 // "ULLZ" in little-endian, starts compressed log files
+#define BENCH_ITERATIONS 1000000 // card placements timed by tools/bench_log.c for each log mode
+#define BENCH_PLAYERS 2
+#define LOG_WRITE_BUFFER_SIZE 65536 // log file stream buffer, flushed once per batch
+
+#define REPLAY_MAGIC 0x50455255 // "UREP" in little-endian
+#define REPLAY_VERSION 2
+#define REPLAY_KIND_BITS 2 // low bits of a record tag storing its replay_kindT, the value is stored above them
+#define REPLAY_VARINT_MAX 10 // bytes of the longest varint (64 bits, 7 per byte)
+#define REPLAY_MIN_PENDING 64
+
+#define SCRATCH_BLOCK_SIZE 65536 // bytes of a scratch arena block, enough for the frames showing many cards
+#define MULTILINE_MIN_CAPACITY 8
+#define WRAP_MAX_LINES (CARTA_DESCRIPTION_LEN/2+1) // a line holds at least a word and a space, so descriptions always fit
+#define FRAME_MIN_CAPACITY 16384 // bytes of the frame buffer at first use, doubled when a screen doesn't fit
+#define TUI_DEFAULT_ROWS 50 // terminal rows assumed when they can't be queried (nor read from LINES)
+#define TERMINAL_DEFAULT_COLUMNS (CARDS_PER_ROW*(CARD_WIDTH+CARDS_HORIZONTAL_SPACING)+CARDS_HORIZONTAL_SPACING) // terminal columns assumed when they can't be queried (nor read from COLUMNS)
+#define TUI_MIN_MESSAGE_ROWS 6 // rows kept below a screen for prompts and messages, taller screens just scroll
+#define CARD_RENDERS_MIN_SLOTS 128 // slots of the card render cache, power of 2 (kept at most half full)
+#define FORMAT_LINE_LEN 512 // stack buffers of formatted prompts, titles and descriptions
+
+#define CHECKPOINT_RING_SIZE 64 // round-start snapshots kept in memory for rollbacks
+#define CHECKPOINT_ZONES (3*MAX_PLAYERS+3) // hand, aula and bonus/malus of each player + mazzo pesca, mazzo scarti and aula studio
 
 // action menu
 #define ACTION_PLAY_HAND 1
 #define ACTION_DRAW 2
 #define ACTION_VIEW_OWN 3
 #define ACTION_VIEW_OTHERS 4
+#define ACTION_ROLLBACK 5
+#define ACTION_TOGGLE_VIEW 6
 #define ACTION_QUIT 0
 // end action menu
 
@@ -34,6 +128,8 @@
 #define MENU_LOADSAVE 2
 #define MENU_STATS 3
 #define MENU_QUIT 0
+#define STATS_NEXT_PAGE 1
+#define STATS_BACK 0
 // end main menu
 
 // pick aula card menu
@@ -79,10 +175,11 @@ ANSI_YELLOW " Grazie per aver giocato ad Unstable Students!" ANSI_RESET "\n"
 #define CARD_EFFECTS_HEADER_HEIGHT 3
 #define CARD_EFFECTS_HEIGHT MAX_EFFECTS+CARD_EFFECTS_HEADER_HEIGHT
 #define CARD_HEIGHT 1+2+CARD_DESCRIPTION_HEIGHT+CARD_EFFECTS_HEIGHT+1
-#define CARDS_PER_ROW 4
+#define CARDS_PER_ROW 4 // cards in a row of a group when the terminal width is unknown (e.g. output to a file)
 #define CARDS_HORIZONTAL_SPACING 2
 #define CARDS_HEADER_LBORDER "["
 #define CARDS_HEADER_RBORDER "]"
+#define COMPACT_TYPE_WIDTH 18 // "#Studente semplice", the longest card type
 #define CARDS_EMPTY_MSG "\\\\ vuoto //"
 
 #define HORIZONTAL_BAR "--------------------------------" // CARD_CONTENT_WIDTH long
@@ -120,6 +217,15 @@ ANSI_YELLOW " Grazie per aver giocato ad Unstable Students!" ANSI_RESET "\n"
 #define ANSI_BG_MAGENTA "\033[45m"
 #define ANSI_BG_CYAN "\033[46m"
 #define ANSI_BG_WHITE "\033[47m"
+#define ANSI_ALT_SCREEN_ON "\033[?1049h"
+#define ANSI_ALT_SCREEN_OFF "\033[?1049l"
+#define ANSI_CLEAR_SCREEN "\033[2J"
+#define ANSI_CLEAR_LINE "\033[K" // from the cursor to the end of the line
+#define ANSI_RESET_SCROLL_REGION "\033[r" // whole screen, also moves the cursor home
+#define ANSI_SCROLL_REGION_FORMAT "\033[%d;%dr" // first and last row (1-based) scrolled by newlines
+#define ANSI_CURSOR_FORMAT "\033[%d;%dH" // given row and column (1-based)
+#define ANSI_SCROLL_UP_FORMAT "\033[%dS" // moves the lines of the scroll region up by the given rows
+#define ANSI_SCROLL_DOWN_FORMAT "\033[%dT" // moves the lines of the scroll region down by the given rows
 
 #define PRETTY_USERNAME ANSI_UNDERLINE "%s" ANSI_RESET
 #define COLORED_CARD_TYPE "%s%s" ANSI_RESET
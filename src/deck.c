@@ -0,0 +1,458 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include "deck.h"
+#include "structs.h"
+#include "card.h"
+#include "utils.h"
+
+/**
+ * @brief initialize deck table internal fields, must always be called before using the deck table
+ * 
+ * @param deck pointer to the deck table
+ */
+void init_deck_table(deck_tableT *deck) {
+	deck->n_definitions = deck->definitions_capacity = 0;
+	deck->definitions = NULL;
+	deck->amounts = NULL;
+	deck->name_slots = NULL;
+	deck->n_name_slots = 0;
+	deck->packs = NULL;
+	deck->n_effects = deck->effects_capacity = 0;
+	deck->effects = NULL;
+	deck->n_overrides = deck->overrides_capacity = 0;
+	deck->overrides = NULL;
+	deck->n_packs = 0;
+	deck->n_cards = 0;
+}
+
+/**
+ * @brief free up memory allocated by the deck table, must always be called after finished using the deck table
+ * 
+ * @param deck pointer to the deck table
+ */
+void clear_deck_table(deck_tableT *deck) {
+	free_wrap(deck->definitions);
+	free_wrap(deck->amounts);
+	free_wrap(deck->name_slots);
+	free_wrap(deck->packs);
+	free_wrap(deck->effects);
+	free_wrap(deck->overrides);
+}
+
+/**
+ * @brief makes room in the deck table for the given amount of definitions, effects and overrides
+ * 
+ * @param deck pointer to the deck table
+ * @param n_definitions total definitions the table must be able to hold
+ * @param n_effects total effects the table must be able to hold
+ * @param n_overrides total copy-count overrides the table must be able to hold
+ */
+void reserve_deck_table(deck_tableT *deck, int n_definitions, int n_effects, int n_overrides) {
+	if (n_definitions > deck->definitions_capacity) {
+		deck->definitions_capacity = deck->definitions_capacity == 0 ? DECK_MIN_CAPACITY : deck->definitions_capacity;
+		while (deck->definitions_capacity < n_definitions)
+			deck->definitions_capacity *= 2;
+		deck->definitions = (cartaT*)realloc_checked(deck->definitions, deck->definitions_capacity*sizeof(cartaT));
+		deck->amounts = (int*)realloc_checked(deck->amounts, deck->definitions_capacity*sizeof(int));
+		deck->packs = (int*)realloc_checked(deck->packs, deck->definitions_capacity*sizeof(int));
+	}
+	if (n_effects > deck->effects_capacity) {
+		deck->effects_capacity = deck->effects_capacity == 0 ? DECK_MIN_CAPACITY : deck->effects_capacity;
+		while (deck->effects_capacity < n_effects)
+			deck->effects_capacity *= 2;
+		deck->effects = (effettoT*)realloc_checked(deck->effects, deck->effects_capacity*sizeof(effettoT));
+		link_deck_effects(deck); // effects pool could have moved
+	}
+	if (n_overrides > deck->overrides_capacity) {
+		deck->overrides_capacity = deck->overrides_capacity == 0 ? DECK_MIN_CAPACITY : deck->overrides_capacity;
+		while (deck->overrides_capacity < n_overrides)
+			deck->overrides_capacity *= 2;
+		deck->overrides = (deck_overrideT*)realloc_checked(deck->overrides, deck->overrides_capacity*sizeof(deck_overrideT));
+	}
+}
+
+/**
+ * @brief returns the slot of a card name in the name index, or the empty slot where it should be inserted
+ * 
+ * @param deck pointer to the deck table, its name index must not be empty
+ * @param name card name
+ * @return int slot
+ */
+int deck_name_slot(const deck_tableT *deck, const char *name) {
+	int slot = hash_string(name) & (deck->n_name_slots-1);
+
+	while (deck->name_slots[slot] != 0 && strncmp(deck->definitions[deck->name_slots[slot]-1].name, name, CARTA_NAME_LEN))
+		slot = (slot+1) & (deck->n_name_slots-1); // linear probing
+	return slot;
+}
+
+/**
+ * @brief adds a definition to the name index, unless its name is already indexed (the first definition of a name wins)
+ * 
+ * @param deck pointer to the deck table
+ * @param idx index of the definition
+ */
+void deck_index_name(deck_tableT *deck, int idx) {
+	int slot = deck_name_slot(deck, deck->definitions[idx].name);
+
+	if (deck->name_slots[slot] == 0)
+		deck->name_slots[slot] = idx+1;
+}
+
+/**
+ * @brief doubles the slots of the name index (so that it stays at most half full), indexing every definition again
+ * 
+ * @param deck pointer to the deck table
+ */
+void grow_deck_name_index(deck_tableT *deck) {
+	free_wrap(deck->name_slots);
+	deck->n_name_slots = deck->n_name_slots == 0 ? 2*DECK_MIN_CAPACITY : deck->n_name_slots*2;
+	deck->name_slots = (int*)calloc_checked(deck->n_name_slots, sizeof(int));
+	for (int i = 0; i < deck->n_definitions; i++)
+		deck_index_name(deck, i);
+}
+
+/**
+ * @brief appends a card definition to the deck table, copying its effects into the effects pool
+ * 
+ * @param deck pointer to the deck table
+ * @param card card definition (its effetti array is copied, not referenced)
+ * @param amount copies of the card in the deck
+ */
+void deck_add_definition(deck_tableT *deck, const cartaT *card, int amount) {
+	cartaT *definition;
+
+	reserve_deck_table(deck, deck->n_definitions+1, deck->n_effects+card->n_effetti, deck->n_overrides);
+
+	definition = &deck->definitions[deck->n_definitions];
+	*definition = *card;
+	definition->next = NULL;
+	definition->effetti = card->n_effetti != 0 ? &deck->effects[deck->n_effects] : NULL;
+	for (int i = 0; i < card->n_effetti; i++)
+		deck->effects[deck->n_effects++] = card->effetti[i];
+
+	deck->packs[deck->n_definitions] = -1;
+	deck->amounts[deck->n_definitions++] = amount;
+	deck->n_cards += amount;
+
+	if (2*deck->n_definitions > deck->n_name_slots)
+		grow_deck_name_index(deck);
+	else
+		deck_index_name(deck, deck->n_definitions-1);
+}
+
+/**
+ * @brief appends a copy-count override of a definition (declared by this or another pack) to the deck table
+ * 
+ * @param deck pointer to the deck table
+ * @param name name of the overridden definition
+ * @param amount new copies of the definition in the deck
+ */
+void deck_add_override(deck_tableT *deck, const char *name, int amount) {
+	deck_overrideT *override;
+
+	reserve_deck_table(deck, deck->n_definitions, deck->n_effects, deck->n_overrides+1);
+
+	override = &deck->overrides[deck->n_overrides++];
+	strncpy(override->name, name, sizeof(override->name));
+	override->name[CARTA_NAME_LEN] = '\0';
+	override->amount = amount;
+}
+
+/**
+ * @brief looks up a definition by card name (card names identify cards in game, so they are unique across packs).
+ * only definitions appended by deck_add_definition are indexed, as the merged deck table's are
+ * 
+ * @param deck pointer to the deck table
+ * @param name card name to look for
+ * @return int index of the definition or -1 if not found
+ */
+int deck_find(const deck_tableT *deck, const char *name) {
+	if (deck->n_name_slots == 0)
+		return -1;
+	return deck->name_slots[deck_name_slot(deck, name)]-1;
+}
+
+/**
+ * @brief derives the pack name from a deck file path: its file name without extension
+ * 
+ * @param source_name deck file path
+ * @param pack_name buffer receiving the pack name, DECK_PACK_NAME_LEN+1 long (out parameter)
+ */
+void deck_pack_name(const char *source_name, char *pack_name) {
+	const char *base = source_name, *extension;
+	size_t len;
+
+	for (const char *c = source_name; *c != '\0'; c++) {
+		if (*c == '/' || *c == '\\')
+			base = c+1;
+	}
+	extension = strrchr(base, '.');
+	len = extension != NULL && extension != base ? (size_t)(extension - base) : strlen(base);
+	len = MIN(len, DECK_PACK_NAME_LEN);
+	memcpy(pack_name, base, len);
+	pack_name[len] = '\0';
+}
+
+/**
+ * @brief merges a single pack table (parsed, cached or embedded) into the deck table, recording the pack of its definitions and
+ * then applying its copy-count overrides. exits on conflicts: pack loaded twice, card names already defined, unknown overridden cards.
+ * 
+ * @param deck pointer to the merged deck table
+ * @param pack pointer to the pack table
+ * @param source_name deck file of the pack, gives the pack name and is shown in errors
+ */
+void deck_merge_pack(deck_tableT *deck, const deck_tableT *pack, const char *source_name) {
+	char pack_name[DECK_PACK_NAME_LEN+1];
+	int pack_idx, idx;
+
+	deck_pack_name(source_name, pack_name);
+	for (int i = 0; i < deck->n_packs; i++) {
+		if (!strcmp(deck->pack_names[i], pack_name)) {
+			fprintf(stderr, "%s: deck pack '%s' is already loaded!\n", source_name, pack_name);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (deck->n_packs == MAX_DECK_PACKS) {
+		fprintf(stderr, "%s: too many deck packs (max " TO_STRING(MAX_DECK_PACKS) ")!\n", source_name);
+		exit(EXIT_FAILURE);
+	}
+	pack_idx = deck->n_packs++;
+	strcpy(deck->pack_names[pack_idx], pack_name);
+
+	for (int i = 0; i < pack->n_definitions; i++) {
+		idx = deck_find(deck, pack->definitions[i].name);
+		if (idx != -1) {
+			fprintf(stderr, "%s: card '%s' is already defined by deck pack '%s'!\n", source_name, pack->definitions[i].name,
+				deck->pack_names[deck->packs[idx]]);
+			exit(EXIT_FAILURE);
+		}
+		deck_add_definition(deck, &pack->definitions[i], pack->amounts[i]);
+		deck->packs[deck->n_definitions-1] = pack_idx;
+	}
+
+	for (int i = 0; i < pack->n_overrides; i++) {
+		idx = deck_find(deck, pack->overrides[i].name);
+		if (idx == -1) {
+			fprintf(stderr, "%s: overridden card '%s' is not defined by any loaded deck pack!\n", source_name, pack->overrides[i].name);
+			exit(EXIT_FAILURE);
+		}
+		deck->n_cards += pack->overrides[i].amount - deck->amounts[idx];
+		deck->amounts[idx] = pack->overrides[i].amount;
+	}
+}
+
+/**
+ * @brief points the effetti of every definition to its effects in the effects pool (definitions effects are stored in order)
+ * 
+ * @param deck pointer to the deck table
+ */
+void link_deck_effects(deck_tableT *deck) {
+	int effect_idx = 0;
+
+	for (int i = 0; i < deck->n_definitions; i++) {
+		deck->definitions[i].effetti = deck->definitions[i].n_effetti != 0 ? &deck->effects[effect_idx] : NULL;
+		effect_idx += deck->definitions[i].n_effetti;
+	}
+}
+
+/**
+ * @brief call this when the deck text doesn't follow the expected format, reports the position of the error. does not return.
+ * 
+ * @param tok pointer to the tokenizer
+ * @param line line of the error
+ * @param column column of the error
+ * @param expected description of the expected token
+ */
+void deck_parse_failed(deck_tokenizerT *tok, int line, int column, const char *expected) {
+	fprintf(stderr, "%s:%d:%d: parse error, expected %s!\n", tok->source_name, line, column, expected);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief moves the tokenizer one character forward keeping track of line and column
+ * 
+ * @param tok pointer to the tokenizer
+ */
+void tokenizer_advance(deck_tokenizerT *tok) {
+	if (tok->text[tok->pos++] == '\n') {
+		tok->line++;
+		tok->column = 1;
+	} else
+		tok->column++;
+}
+
+/**
+ * @brief skips whitespace (newlines included) as the " " directive of scanf would do
+ * 
+ * @param tok pointer to the tokenizer
+ * @return true if there are more characters to read
+ * @return false if the end of the text was reached
+ */
+bool tokenizer_skip_spaces(deck_tokenizerT *tok) {
+	while (tok->pos < tok->length && isspace((unsigned char)tok->text[tok->pos]))
+		tokenizer_advance(tok);
+	return tok->pos < tok->length;
+}
+
+/**
+ * @brief reads an integer within the given range, as " %d" would do
+ * 
+ * @param tok pointer to the tokenizer
+ * @param min minimum allowed value
+ * @param max maximum allowed value
+ * @param expected description of the integer, shown in parse errors
+ * @return int read integer
+ */
+int tokenizer_int(deck_tokenizerT *tok, int min, int max, const char *expected) {
+	int line, column, digits = 0;
+	long long val = 0;
+	bool negative = false;
+
+	tokenizer_skip_spaces(tok);
+	line = tok->line;
+	column = tok->column;
+
+	if (tok->pos < tok->length && (tok->text[tok->pos] == '-' || tok->text[tok->pos] == '+')) {
+		negative = tok->text[tok->pos] == '-';
+		tokenizer_advance(tok);
+	}
+	for (; tok->pos < tok->length && isdigit((unsigned char)tok->text[tok->pos]); digits++) {
+		if (val <= max) // stop accumulating once out of range, avoiding overflow
+			val = val*10 + (tok->text[tok->pos] - '0');
+		tokenizer_advance(tok);
+	}
+	if (negative)
+		val = -val;
+
+	if (digits == 0 || val < min || val > max)
+		deck_parse_failed(tok, line, column, expected);
+	return (int)val;
+}
+
+/**
+ * @brief reads the rest of the line (after leading whitespace), as " %[^\n]" would do
+ * 
+ * @param tok pointer to the tokenizer
+ * @param dest buffer receiving the line, at least max_len+1 long
+ * @param max_len maximum length of the line
+ * @param expected description of the line, shown in parse errors
+ */
+void tokenizer_line(deck_tokenizerT *tok, char *dest, size_t max_len, const char *expected) {
+	int line, column;
+	size_t start, len;
+
+	tokenizer_skip_spaces(tok);
+	line = tok->line;
+	column = tok->column;
+
+	start = tok->pos;
+	while (tok->pos < tok->length && tok->text[tok->pos] != '\n')
+		tokenizer_advance(tok);
+	len = tok->pos - start;
+	if (len > 0 && tok->text[start+len-1] == '\r') // tolerate CRLF line endings
+		len--;
+
+	if (len == 0 || len > max_len)
+		deck_parse_failed(tok, line, column, expected);
+	memcpy(dest, &tok->text[start], len);
+	dest[len] = '\0';
+}
+
+/**
+ * @brief parses every card definition of the FILE_MAZZO text format into the deck table in a single pass over the text.
+ * records starting with DECK_OVERRIDE_MARK are copy-count overrides: the new amount followed by the name of the card.
+ * 
+ * @param deck pointer to already initialized deck table
+ * @param text whole deck text
+ * @param length length of the text
+ * @param source_name name of the deck source, shown in parse errors
+ */
+void parse_deck(deck_tableT *deck, const char *text, size_t length, const char *source_name) {
+	cartaT card;
+	effettoT effects[MAX_EFFECTS];
+	int amount;
+	deck_tokenizerT tok = { source_name, text, length, 0, 1, 1 };
+
+	while (tokenizer_skip_spaces(&tok)) {
+		if (tok.text[tok.pos] == DECK_OVERRIDE_MARK) {
+			tokenizer_advance(&tok);
+			amount = tokenizer_int(&tok, 0, INT_MAX, "overridden number of copies of the card");
+			tokenizer_line(&tok, card.name, CARTA_NAME_LEN, "overridden card name (max " TO_STRING(CARTA_NAME_LEN) " characters)");
+			deck_add_override(deck, card.name, amount);
+		} else {
+			memset(&card, 0, sizeof(cartaT));
+			amount = tokenizer_int(&tok, 0, INT_MAX, "number of copies of the card");
+			tokenizer_line(&tok, card.name, CARTA_NAME_LEN, "card name (max " TO_STRING(CARTA_NAME_LEN) " characters)");
+			tokenizer_line(&tok, card.description, CARTA_DESCRIPTION_LEN,
+				"card description (max " TO_STRING(CARTA_DESCRIPTION_LEN) " characters)");
+			card.tipo = (tipo_cartaT)tokenizer_int(&tok, MATRICOLA, ISTANTANEA, "card type");
+			card.n_effetti = tokenizer_int(&tok, 0, MAX_EFFECTS, "number of effects (max " TO_STRING(MAX_EFFECTS) ")");
+			for (int i = 0; i < card.n_effetti; i++) {
+				effects[i].azione = (azioneT)tokenizer_int(&tok, GIOCA, INGEGNERE, "effect action");
+				effects[i].target_giocatori = (target_giocatoriT)tokenizer_int(&tok, IO, TUTTI, "effect target players");
+				effects[i].target_carta = (tipo_cartaT)tokenizer_int(&tok, ALL, ISTANTANEA, "effect target card type");
+			}
+			card.effetti = effects;
+			card.quando = (quandoT)tokenizer_int(&tok, SUBITO, SEMPRE, "card quando");
+			card.opzionale = tokenizer_int(&tok, INT_MIN, INT_MAX, "card optional flag") != 0;
+
+			deck_add_definition(deck, &card, amount);
+		}
+	}
+}
+
+/**
+ * @brief creates the cards linked list of the deck, with each definition repeated by its amount (in definitions order)
+ * 
+ * @param deck pointer to the deck table
+ * @param n_cards out parameter containing number of created cards
+ * @return cartaT* head of the created cards linked list
+ */
+cartaT *instantiate_deck(const deck_tableT *deck, int *n_cards) {
+	cartaT *head = NULL, **tail_next = &head;
+
+	for (int i = 0; i < deck->n_definitions; i++) {
+		for (int copy = 0; copy < deck->amounts[i]; copy++) {
+			*tail_next = duplicate_carta(&deck->definitions[i]);
+			tail_next = &(*tail_next)->next;
+		}
+	}
+	*tail_next = NULL;
+
+	*n_cards = deck->n_cards;
+	return head;
+}
+
+
+/**
+ * @brief hashes every definition of the deck table with its amount, in definitions order (which decides the order of
+ * the instantiated cards): two decks with the same hash give the same game from the same seed
+ * 
+ * @param deck pointer to the deck table
+ * @return unsigned int hash of the deck
+ */
+unsigned int hash_deck_table(const deck_tableT *deck) {
+	unsigned int hash = hash_bytes(&deck->n_definitions, sizeof(deck->n_definitions));
+	const cartaT *card;
+
+	for (int i = 0; i < deck->n_definitions; i++) {
+		card = &deck->definitions[i];
+		hash = hash_update(hash, card->name, strlen(card->name)+1); // the terminator separates adjacent strings
+		hash = hash_update(hash, card->description, strlen(card->description)+1);
+		hash = hash_update(hash, &card->tipo, sizeof(card->tipo));
+		hash = hash_update(hash, &card->n_effetti, sizeof(card->n_effetti));
+		for (int j = 0; j < card->n_effetti; j++) { // fields one by one, skipping the padding of the structs
+			hash = hash_update(hash, &card->effetti[j].azione, sizeof(card->effetti[j].azione));
+			hash = hash_update(hash, &card->effetti[j].target_giocatori, sizeof(card->effetti[j].target_giocatori));
+			hash = hash_update(hash, &card->effetti[j].target_carta, sizeof(card->effetti[j].target_carta));
+		}
+		hash = hash_update(hash, &card->quando, sizeof(card->quando));
+		hash = hash_update(hash, &card->opzionale, sizeof(card->opzionale));
+		hash = hash_update(hash, &deck->amounts[i], sizeof(deck->amounts[i]));
+	}
+	return hash;
+}
\ No newline at end of file
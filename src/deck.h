@@ -0,0 +1,23 @@
+#ifndef DECK_H
+#define DECK_H
+
+#include <stddef.h>
+#include "types.h"
+
+void init_deck_table(deck_tableT *deck);
+void clear_deck_table(deck_tableT *deck);
+void reserve_deck_table(deck_tableT *deck, int n_definitions, int n_effects, int n_overrides);
+void deck_add_definition(deck_tableT *deck, const cartaT *card, int amount);
+void deck_add_override(deck_tableT *deck, const char *name, int amount);
+int deck_find(const deck_tableT *deck, const char *name);
+void deck_merge_pack(deck_tableT *deck, const deck_tableT *pack, const char *source_name);
+void link_deck_effects(deck_tableT *deck);
+void parse_deck(deck_tableT *deck, const char *text, size_t length, const char *source_name);
+cartaT *instantiate_deck(const deck_tableT *deck, int *n_cards);
+unsigned int hash_deck_table(const deck_tableT *deck);
+
+#ifdef EMBEDDED_MAZZO
+extern const deck_tableT EMBEDDED_DECK; // FILE_MAZZO compiled into the executable, generated by tools/gen_mazzo.c
+#endif
+
+#endif // DECK_H
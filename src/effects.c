@@ -6,6 +6,7 @@
 #include "gameplay.h"
 #include "card.h"
 #include "utils.h"
+#include "input.h"
 #include "graphics.h"
 
 /**
@@ -17,7 +18,7 @@
  * @param effect ELIMINA effect
  */
 void apply_effect_elimina_target(game_contextT *game_ctx, giocatoreT *target, effettoT *effect) {
-	char *prompt;
+	char prompt[FORMAT_LINE_LEN];
 	cartaT *deleted;
 
 	if (is_self(game_ctx, target)) {
@@ -26,7 +27,7 @@ void apply_effect_elimina_target(game_contextT *game_ctx, giocatoreT *target, ef
 			tipo_cartaT_color(effect->target_carta),
 			tipo_cartaT_str(effect->target_carta)
 		);
-		asprintf_sss(&prompt, "[%s] Scegli la carta " COLORED_CARD_TYPE " che vuoi eliminare dalla tua aula.",
+		format_buf(prompt, sizeof(prompt), "[%s] Scegli la carta " COLORED_CARD_TYPE " che vuoi eliminare dalla tua aula.",
 			game_ctx->curr_player->name,
 			tipo_cartaT_color(effect->target_carta),
 			tipo_cartaT_str(effect->target_carta)
@@ -34,12 +35,11 @@ void apply_effect_elimina_target(game_contextT *game_ctx, giocatoreT *target, ef
 		deleted = pick_aula_card(game_ctx, game_ctx->curr_player, effect->target_carta, prompt);
 		if (deleted != NULL) {
 			printf("[%s] Hai scelto di eliminare '%s' dalla tua aula!\n", game_ctx->curr_player->name, deleted->name);
-			log_ss(game_ctx, "%s ha scelto di eliminare '%s' dalla sua aula.", game_ctx->curr_player->name, deleted->name);
+			LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_DELETE_OWN,
+				game_ctx->curr_player, NULL, deleted, NULL, effect->target_carta, effect);
 		} else {
-			log_ss(game_ctx, "%s avrebbe dovuto eliminare una carta %s dalla sua aula, ma non ne aveva.",
-				game_ctx->curr_player->name,
-				tipo_cartaT_str(effect->target_carta)
-			);
+			LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_DELETE_OWN_NONE,
+				game_ctx->curr_player, NULL, NULL, NULL, effect->target_carta, effect);
 		}
 	} else {
 		printf("[%s] Devi eliminare una carta " COLORED_CARD_TYPE " dall'aula di " PRETTY_USERNAME ".\n",
@@ -48,7 +48,7 @@ void apply_effect_elimina_target(game_contextT *game_ctx, giocatoreT *target, ef
 			tipo_cartaT_str(effect->target_carta),
 			target->name
 		);
-		asprintf_ssss(&prompt, "[%s] Scegli la carta " COLORED_CARD_TYPE " che vuoi eliminare dall'aula di " PRETTY_USERNAME ".",
+		format_buf(prompt, sizeof(prompt), "[%s] Scegli la carta " COLORED_CARD_TYPE " che vuoi eliminare dall'aula di " PRETTY_USERNAME ".",
 			game_ctx->curr_player->name,
 			tipo_cartaT_color(effect->target_carta),
 			tipo_cartaT_str(effect->target_carta),
@@ -61,13 +61,11 @@ void apply_effect_elimina_target(game_contextT *game_ctx, giocatoreT *target, ef
 				deleted->name,
 				target->name
 			);
-			log_sss(game_ctx, "%s ha eliminato '%s' dall'aula di %s.", game_ctx->curr_player->name, deleted->name, target->name);
+			LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_DELETE,
+				game_ctx->curr_player, target, deleted, NULL, effect->target_carta, effect);
 		} else {
-			log_sss(game_ctx, "%s avrebbe dovuto eliminare una carta %s dall'aula di %s, ma non ne aveva.",
-				game_ctx->curr_player->name,
-				tipo_cartaT_str(effect->target_carta),
-				target->name
-			);
+			LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_DELETE_NONE,
+				game_ctx->curr_player, target, NULL, NULL, effect->target_carta, effect);
 		}
 	}
 
@@ -76,7 +74,6 @@ void apply_effect_elimina_target(game_contextT *game_ctx, giocatoreT *target, ef
 		dispose_card(game_ctx, deleted);
 	}
 
-	free_wrap(prompt);
 }
 
 /**
@@ -88,7 +85,7 @@ void apply_effect_elimina_target(game_contextT *game_ctx, giocatoreT *target, ef
  * @param effect SCARTA effect
  */
 void apply_effect_scarta_target(game_contextT *game_ctx, giocatoreT *target, effettoT *effect) {
-	char *title;
+	char title[FORMAT_LINE_LEN];
 	cartaT *discarded_card;
 
 	if (is_self(game_ctx, target)) { // target is self, picking which card to discard is allowed
@@ -99,12 +96,11 @@ void apply_effect_scarta_target(game_contextT *game_ctx, giocatoreT *target, eff
 		);
 
 		if (effect->target_carta == ALL)
-			title = strdup_checked("La tua mano");
+			format_buf(title, sizeof(title), "La tua mano");
 		else
-			asprintf_s(&title, "%s nella tua mano", tipo_cartaT_str(effect->target_carta));
+			format_buf(title, sizeof(title), "%s nella tua mano", tipo_cartaT_str(effect->target_carta));
 
 		discard_card(game_ctx, &game_ctx->curr_player->carte, effect->target_carta, title);
-		free_wrap(title);
 	} else { // target is another player, random card extraction is used
 		printf("[%s] " PRETTY_USERNAME " ti fa scartare una carta " COLORED_CARD_TYPE " dalla mano!\n",
 			target->name,
@@ -117,22 +113,16 @@ void apply_effect_scarta_target(game_contextT *game_ctx, giocatoreT *target, eff
 			unlink_card(&target->carte, discarded_card);
 			dispose_card(game_ctx, discarded_card); // dispose discarded card
 			printf(PRETTY_USERNAME " ha scartato '%s'!\n", target->name, discarded_card->name);
-			log_sss(game_ctx, "%s ha scartato %s a causa dell'attacco di %s.",
-				target->name,
-				discarded_card->name,
-				game_ctx->curr_player->name
-			);
+			LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_ATTACK_DISCARD,
+				game_ctx->curr_player, target, discarded_card, NULL, effect->target_carta, effect);
 		} else {
 			printf(PRETTY_USERNAME " non aveva carte " COLORED_CARD_TYPE " da scartare nella sua mano!\n",
 				target->name,
 				tipo_cartaT_color(effect->target_carta),
 				tipo_cartaT_str(effect->target_carta)
 			);
-			log_sss(game_ctx, "%s doveva scartare una carta %s a causa dell'attacco di %s, ma non ne aveva.",
-				target->name,
-				tipo_cartaT_str(effect->target_carta),
-				game_ctx->curr_player->name
-			);
+			LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_ATTACK_DISCARD_NONE,
+				game_ctx->curr_player, target, NULL, NULL, effect->target_carta, effect);
 		}
 	}
 }
@@ -154,16 +144,11 @@ void apply_effect_gioca_target(game_contextT *game_ctx, giocatoreT *target, effe
 			tipo_cartaT_color(effect->target_carta),
 			tipo_cartaT_str(effect->target_carta)
 		);
-		log_sss(game_ctx, "%s deve giocare una carta %s grazie all'effetto %s.",
-			game_ctx->curr_player->name,
-			tipo_cartaT_str(effect->target_carta),
-			azioneT_str(effect->azione)
-		);
+		LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_MUST_PLAY,
+			game_ctx->curr_player, NULL, NULL, NULL, effect->target_carta, effect);
 		if (!play_card(game_ctx, effect->target_carta)) {
-			log_ss(game_ctx, "%s avrebbe dovuto giocare una carta %s, ma non ne aveva.",
-				target->name,
-				tipo_cartaT_str(effect->target_carta)
-			);
+			LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_PLAY_NONE,
+				thrower, target, NULL, NULL, effect->target_carta, effect);
 		}
 	} else {
 		printf("[%s] " PRETTY_USERNAME " ti fa giocare una carta " COLORED_CARD_TYPE " dal tuo mazzo.\n",
@@ -172,19 +157,13 @@ void apply_effect_gioca_target(game_contextT *game_ctx, giocatoreT *target, effe
 			tipo_cartaT_color(effect->target_carta),
 			tipo_cartaT_str(effect->target_carta)
 		);
-		log_ssss(game_ctx, "%s deve giocare una carta %s grazie all'effetto %s di %s.",
-			target->name,
-			tipo_cartaT_str(effect->target_carta),
-			azioneT_str(effect->azione),
-			thrower->name
-		);
+		LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_FORCED_PLAY,
+			thrower, target, NULL, NULL, effect->target_carta, effect);
 
 		switch_player(game_ctx, target); // switch current player to the target player to create a sub-round for target to play a card
 		if (!play_card(game_ctx, effect->target_carta)) {
-			log_ss(game_ctx, "%s avrebbe dovuto giocare una carta %s, ma non ne aveva.",
-				target->name,
-				tipo_cartaT_str(effect->target_carta)
-			);
+			LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_PLAY_NONE,
+				thrower, target, NULL, NULL, effect->target_carta, effect);
 		}
 		switch_player(game_ctx, thrower); // switch back to original card thrower player
 	}
@@ -199,7 +178,7 @@ void apply_effect_gioca_target(game_contextT *game_ctx, giocatoreT *target, effe
  * @param effect RUBA effect
  */
 void apply_effect_ruba_target(game_contextT *game_ctx, giocatoreT *target, effettoT *effect) {
-	char *prompt, *title;
+	char prompt[FORMAT_LINE_LEN], title[FORMAT_LINE_LEN];
 	bool can_steal = false, stolen = false;
 	cartaT *card, *target_cards = effect->target_carta == STUDENTE ? target->aula : target->bonus_malus;
 
@@ -214,13 +193,13 @@ void apply_effect_ruba_target(game_contextT *game_ctx, giocatoreT *target, effet
 		tipo_cartaT_str(effect->target_carta),
 		target->name
 	);
-	asprintf_ssss(&prompt, "[%s] Scegli la carta " COLORED_CARD_TYPE " che vuoi rubare a " PRETTY_USERNAME ".",
+	format_buf(prompt, sizeof(prompt), "[%s] Scegli la carta " COLORED_CARD_TYPE " che vuoi rubare a " PRETTY_USERNAME ".",
 		game_ctx->curr_player->name,
 		tipo_cartaT_color(effect->target_carta),
 		tipo_cartaT_str(effect->target_carta),
 		target->name
 	);
-	asprintf_ss(&title, "Carte %s di %s", tipo_cartaT_str(effect->target_carta), target->name);
+	format_buf(title, sizeof(title), "Carte %s di %s", tipo_cartaT_str(effect->target_carta), target->name);
 
 	// check if any target card can be stolen by curr_player first
 	for (card = target_cards; card != NULL && !can_steal; card = card->next) {
@@ -238,7 +217,8 @@ void apply_effect_ruba_target(game_contextT *game_ctx, giocatoreT *target, effet
 				leave_aula(game_ctx, target, card, DISPATCH_EFFECTS);
 				join_aula(game_ctx, game_ctx->curr_player, card);
 				printf("Hai rubato: %s\n", card->name);
-				log_sss(game_ctx, "%s ha rubato '%s' a %s.", game_ctx->curr_player->name, card->name, target->name);
+				LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_STEAL,
+					game_ctx->curr_player, target, card, NULL, effect->target_carta, effect);
 				stolen = true;
 			} else
 				printf("Non puoi rubare '%s' dato che ne hai una uguale nella tua aula.\n", card->name);
@@ -249,15 +229,10 @@ void apply_effect_ruba_target(game_contextT *game_ctx, giocatoreT *target, effet
 			tipo_cartaT_color(effect->target_carta),
 			tipo_cartaT_str(effect->target_carta)
 		);
-		log_sss(game_ctx, "%s avrebbe dovuto rubare una carta %s a %s, ma non ne aveva.",
-			game_ctx->curr_player->name,
-			tipo_cartaT_str(effect->target_carta),
-			target->name
-		);
+		LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_STEAL_NONE,
+			game_ctx->curr_player, target, NULL, NULL, effect->target_carta, effect);
 	}
 
-	free_wrap(title);
-	free_wrap(prompt);
 }
 
 /**
@@ -287,18 +262,16 @@ void apply_effect_prendi_target(game_contextT *game_ctx, giocatoreT *target, eff
 		unlink_card(&target->carte, stolen_card); // remove extracted card from target's hand
 		push_card(&game_ctx->curr_player->carte, stolen_card); // add extracted card to thrower's hand
 		printf("Hai rubato '%s' dalla mano di " PRETTY_USERNAME "!\n", stolen_card->name, target->name);
-		log_sss(game_ctx, "%s ha rubato '%s' dalla mano di %s.", game_ctx->curr_player->name, stolen_card->name, target->name);
+		LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_STEAL_HAND,
+			game_ctx->curr_player, target, stolen_card, NULL, effect->target_carta, effect);
 	} else {
 		printf(PRETTY_USERNAME " non aveva carte " COLORED_CARD_TYPE " da rubare nella sua mano!\n",
 			tipo_cartaT_color(effect->target_carta),
 			tipo_cartaT_str(effect->target_carta),
 			target->name
 		);
-		log_sss(game_ctx, "%s doveva rubare una carta %s dalla mano di %s, ma non ne aveva.",
-			game_ctx->curr_player->name,
-			tipo_cartaT_str(effect->target_carta),
-			target->name
-		);
+		LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_STEAL_HAND_NONE,
+			game_ctx->curr_player, target, NULL, NULL, effect->target_carta, effect);
 	}
 }
 
@@ -320,11 +293,8 @@ void apply_effect_pesca_target(game_contextT *game_ctx, giocatoreT *target, effe
 			tipo_cartaT_color(effect->target_carta),
 			tipo_cartaT_str(effect->target_carta)
 		);
-		log_sss(game_ctx, "%s deve pescare una carta %s grazie all'effetto %s.",
-			game_ctx->curr_player->name,
-			tipo_cartaT_str(effect->target_carta),
-			azioneT_str(effect->azione)
-		);
+		LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_MUST_DRAW,
+			game_ctx->curr_player, NULL, NULL, NULL, effect->target_carta, effect);
 		drawn_card = draw_card(game_ctx);
 		if (!match_card_type(drawn_card, effect->target_carta)) {
 			// dispose card as it is not of the specified type
@@ -338,12 +308,8 @@ void apply_effect_pesca_target(game_contextT *game_ctx, giocatoreT *target, effe
 				tipo_cartaT_color(drawn_card->tipo),
 				tipo_cartaT_str(drawn_card->tipo)
 			);
-			log_ssss(game_ctx, "%s avrebbe dovuto pescare una carta %s, ma ha pescato '%s' (%s), scartandola.",
-				target->name,
-				tipo_cartaT_str(effect->target_carta),
-				drawn_card->name,
-				tipo_cartaT_str(drawn_card->tipo)
-			);
+			LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_DRAW_MISMATCH,
+				thrower, target, drawn_card, NULL, effect->target_carta, effect);
 		}
 	} else {
 		printf("[%s] " PRETTY_USERNAME " ti fa pescare una carta " COLORED_CARD_TYPE ".\n",
@@ -352,12 +318,8 @@ void apply_effect_pesca_target(game_contextT *game_ctx, giocatoreT *target, effe
 			tipo_cartaT_color(effect->target_carta),
 			tipo_cartaT_str(effect->target_carta)
 		);
-		log_ssss(game_ctx, "%s deve pescare una carta %s grazie all'effetto %s di %s.",
-			target->name,
-			tipo_cartaT_str(effect->target_carta),
-			azioneT_str(effect->azione),
-			thrower->name
-		);
+		LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_FORCED_DRAW,
+			thrower, target, NULL, NULL, effect->target_carta, effect);
 		switch_player(game_ctx, target); // switch current player to the target player to create a sub-round for target to draw a card
 		drawn_card = draw_card(game_ctx);
 		if (!match_card_type(drawn_card, effect->target_carta)) {
@@ -372,12 +334,8 @@ void apply_effect_pesca_target(game_contextT *game_ctx, giocatoreT *target, effe
 				tipo_cartaT_color(drawn_card->tipo),
 				tipo_cartaT_str(drawn_card->tipo)
 			);
-			log_ssss(game_ctx, "%s avrebbe dovuto pescare una carta %s, ma ha pescato '%s' (%s), scartandola.",
-				target->name,
-				tipo_cartaT_str(effect->target_carta),
-				drawn_card->name,
-				tipo_cartaT_str(drawn_card->tipo)
-			);
+			LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_DRAW_MISMATCH,
+				thrower, target, drawn_card, NULL, effect->target_carta, effect);
 		}
 		switch_player(game_ctx, thrower); // switch back to original card thrower player
 	}
@@ -405,11 +363,8 @@ void apply_effect_scambia_target(game_contextT *game_ctx, giocatoreT *target, ef
 		target->name,
 		azioneT_str(effect->azione)
 	);
-	log_sss(game_ctx, "%s scambia il suo mazzo con quello di %s grazie all'effetto %s.",
-		game_ctx->curr_player->name,
-		target->name,
-		azioneT_str(effect->azione)
-	);
+	LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_SWAP_HANDS,
+		game_ctx->curr_player, target, NULL, NULL, effect->target_carta, effect);
 
 	// swap hands
 	game_ctx->curr_player->carte = target->carte;
@@ -482,7 +437,7 @@ void apply_effect_target(game_contextT *game_ctx, effettoT *effect, giocatoreT *
  * @return false if effect wasn't blocked
  */
 bool apply_effect(game_contextT *game_ctx, cartaT *card, effettoT *effect, giocatoreT **target_tu) {
-	char *pick_player_prompt;
+	char pick_player_prompt[FORMAT_LINE_LEN];
 	giocatoreT *target;
 	bool blocked = false;
 
@@ -496,18 +451,17 @@ bool apply_effect(game_contextT *game_ctx, cartaT *card, effettoT *effect, gioca
 			if (*target_tu == NULL) { // check if target tu was already asked in previous TU effects for this card
 				// two different cases for messages (SCAMBIA didn't respect same phrase composition as other actions)
 				if (effect->azione == SCAMBIA)
-					asprintf_s(&pick_player_prompt, "[%s]: Scegli il giocatore col quale vuoi scambiare il tuo mazzo.",
+					format_buf(pick_player_prompt, sizeof(pick_player_prompt), "[%s]: Scegli il giocatore col quale vuoi scambiare il tuo mazzo.",
 						game_ctx->curr_player->name
 					);
 				else
-					asprintf_ssss(&pick_player_prompt, "[%s]: Scegli il giocatore al quale vuoi %s una carta " COLORED_CARD_TYPE ".",
+					format_buf(pick_player_prompt, sizeof(pick_player_prompt), "[%s]: Scegli il giocatore al quale vuoi %s una carta " COLORED_CARD_TYPE ".",
 						game_ctx->curr_player->name,
 						azioneT_verb_str(effect->azione),
 						tipo_cartaT_color(effect->target_carta),
 						tipo_cartaT_str(effect->target_carta)
 					);
 				*target_tu = pick_player(game_ctx, pick_player_prompt, !ALLOW_SELF, !ALLOW_ALL);
-				free_wrap(pick_player_prompt);
 			}
 			if (!target_defends(game_ctx, *target_tu, card, effect))
 				apply_effect_target(game_ctx, effect, *target_tu);
@@ -590,7 +544,8 @@ void apply_effects_now(game_contextT *game_ctx, cartaT *card) {
 					card->name,
 					game_ctx->curr_player->name
 				);
-				log_ss(game_ctx, "La catena degli effetti di '%s' giocata da %s e' stata interrotta.", card->name, game_ctx->curr_player->name);
+				LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_CHAIN_BLOCKED,
+					game_ctx->curr_player, NULL, card, NULL, card->tipo, NULL);
 				blocked = true; // stop executing further effects
 			}
 		}
@@ -610,11 +565,8 @@ void apply_effects_now(game_contextT *game_ctx, cartaT *card) {
  */
 void apply_effects(game_contextT *game_ctx, cartaT *card, quandoT quando) {
 	if (card->quando == quando) {
-		log_sss(game_ctx, "Applicazione degli effetti di '%s' (%s) di %s.",
-			card->name,
-			quandoT_str(card->quando),
-			game_ctx->curr_player->name
-		);
+		LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS, LOG_EV_APPLY_EFFECTS,
+			game_ctx->curr_player, NULL, card, NULL, card->tipo, NULL);
 		apply_effects_now(game_ctx, card);
 	}
 }
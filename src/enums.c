@@ -117,4 +117,20 @@ const char *azioneT_verb_str(azioneT azione) {
 		// no INGEGNERE | IMPEDIRE | MOSTRA | BLOCCA | SCAMBIA
 	};
 	return mapping[azione];
+}
+
+/**
+ * @brief converts a stats metric to the string describing the ranking by it
+ * 
+ * @param metric stats metric to convert to string
+ * @return const char* corresponding string
+ */
+const char *stats_metricT_str(stats_metricT metric) {
+	static const char *mapping[] = {
+		[METRIC_WINS] = "partite vinte",
+		[METRIC_ROUNDS] = "round giocati",
+		[METRIC_DISCARDED] = "carte scartate",
+		[METRIC_PLAYED_CARDS] = "carte giocate"
+	};
+	return mapping[metric];
 }
\ No newline at end of file
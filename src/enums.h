@@ -44,11 +44,106 @@ enum TargetGiocatori {
 	TUTTI
 };
 
+// binary log events, rendered as text by tools/log_print.c (never reorder: values are stored in FILE_LOG)
+enum LogEventType {
+	// dictionary records, followed by their string in 16 bytes chunks
+	LOG_EV_PLAYER, // actor: seat of the player
+	LOG_EV_CARD, // card: card id, card_type: tipo of the card, effect: quando of the card
+	LOG_EV_SAVE_PATH,
+	// session events (without round)
+	LOG_EV_START, // card: LOG_MAGIC, other_card: LOG_VERSION
+	LOG_EV_STOP,
+	LOG_EV_NEW_GAME,
+	LOG_EV_LOAD_GAME,
+	LOG_EV_DECK_LOADED, // other_card: number of cards
+	LOG_EV_CLOSE,
+	// round events
+	LOG_EV_SAVE,
+	LOG_EV_ROLLBACK,
+	LOG_EV_DRAW,
+	LOG_EV_DISCARD,
+	LOG_EV_DISCARD_NONE,
+	LOG_EV_NO_PLAYABLE,
+	LOG_EV_PLAY_PREVENTED,
+	LOG_EV_PLAY,
+	LOG_EV_PLAY_ON,
+	LOG_EV_PLAY_DUPLICATE,
+	LOG_EV_DEFEND_PLACEMENT, // other_card: defense card
+	LOG_EV_DEFEND_EFFECT, // other_card: defense card
+	LOG_EV_JOIN_AULA,
+	LOG_EV_LEAVE_AULA,
+	LOG_EV_APPLY_EFFECTS,
+	LOG_EV_CHAIN_BLOCKED,
+	LOG_EV_DELETE_OWN,
+	LOG_EV_DELETE_OWN_NONE,
+	LOG_EV_DELETE,
+	LOG_EV_DELETE_NONE,
+	LOG_EV_ATTACK_DISCARD,
+	LOG_EV_ATTACK_DISCARD_NONE,
+	LOG_EV_MUST_PLAY,
+	LOG_EV_FORCED_PLAY,
+	LOG_EV_PLAY_NONE,
+	LOG_EV_STEAL,
+	LOG_EV_STEAL_NONE,
+	LOG_EV_STEAL_HAND,
+	LOG_EV_STEAL_HAND_NONE,
+	LOG_EV_MUST_DRAW,
+	LOG_EV_FORCED_DRAW,
+	LOG_EV_DRAW_MISMATCH,
+	LOG_EV_SWAP_HANDS,
+	LOG_EV_WIN,
+	LOG_EV_ROUND_END, // other_card: cards in the hand of the actor
+	LOG_EV_COUNT
+};
+
+// log severity levels, a level enables the events of that level and of the higher ones
+enum LogLevel {
+	LOG_LEVEL_DETAIL, // every card and effect action
+	LOG_LEVEL_ROUND, // round summaries: saves, rollbacks, end of rounds and wins
+	LOG_LEVEL_SESSION, // game creation, loading and closing
+	LOG_LEVEL_OFF // no log file is written at all
+};
+
+// log categories, combined in a bit mask
+enum LogCategory {
+	LOG_CAT_SESSION = 1 << 0,
+	LOG_CAT_ROUND = 1 << 1,
+	LOG_CAT_CARDS = 1 << 2, // draws, discards, plays and aula changes
+	LOG_CAT_EFFECTS = 1 << 3,
+	LOG_CAT_DEFENSE = 1 << 4,
+	LOG_CAT_ALL = (1 << 5) - 1
+};
+
+// kinds of the records of a replay file, stored in the REPLAY_KIND_BITS low bits of each record tag
+enum ReplayKind {
+	REPLAY_INT, // integer returned by get_int
+	REPLAY_CHOICE, // yes or no answer returned by ask_choice
+	REPLAY_TEXT, // line returned by get_text, the value is its length and its bytes follow
+	REPLAY_END // final state of the game, the value is the round number and the state hash and recording time follow
+};
+
+// lifetime counters of the players stats ranked by the stats summary
+enum StatsMetric {
+	METRIC_WINS,
+	METRIC_ROUNDS,
+	METRIC_DISCARDED,
+	METRIC_PLAYED_CARDS,
+	METRICS_COUNT
+};
+
+// advisory locks of the files shared by game processes running at the same time
+enum FileLock {
+	FILE_UNLOCK,
+	FILE_LOCK_READ, // shared with other readers
+	FILE_LOCK_WRITE // exclusive
+};
+
 const char *quandoT_str(quandoT quando);
 const char *target_giocatoriT_str(target_giocatoriT target);
 const char *tipo_cartaT_str(tipo_cartaT tipo);
 const char *tipo_cartaT_color(tipo_cartaT tipo);
 const char *azioneT_str(azioneT azione);
 const char *azioneT_verb_str(azioneT azione);
+const char *stats_metricT_str(stats_metricT metric);
 
 #endif
\ No newline at end of file
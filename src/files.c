@@ -1,11 +1,23 @@
+#define _POSIX_C_SOURCE 200809L // fileno
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <errno.h>
+#endif
 #include "files.h"
 #include "card.h"
 #include "utils.h"
 #include "logging.h"
 #include "format.h"
 #include "saves.h"
+#include "catalog.h"
+#include "deck.h"
+#include "stats.h"
 
 /**
  * @brief call this when an error while reading from a file occurs
@@ -25,19 +37,6 @@ void file_write_failed(void) {
 	exit(EXIT_FAILURE);
 }
 
-/**
- * @brief reads one integer from a file stream and ensures correct reading
- * 
- * @param fp file stream
- * @return int read integer
- */
-int read_int(FILE *fp) {
-	int val;
-	if (fscanf(fp, " %d", &val) != ONE_ELEMENT)
-		file_read_failed();
-	return val;
-}
-
 /**
  * @brief writes one integer to a file stream in binary form and ensures successful writing
  * 
@@ -141,16 +140,61 @@ giocatoreT *load_player(FILE *fp) {
 	return player;
 }
 
+/**
+ * @brief reads the save metadata header from the current position of the file stream
+ * 
+ * @param fp file stream
+ * @param header pointer to header to be read into (out parameter)
+ * @return true if a valid metadata header was read, its names are always NUL-terminated
+ * @return false if the stream doesn't start with a metadata header (legacy save), couldn't be read or has an invalid
+ * players count
+ */
+bool read_header(FILE *fp, save_headerT *header) {
+	if (fread(header, sizeof(save_headerT), ONE_ELEMENT, fp) != ONE_ELEMENT || header->magic != SAVE_HEADER_MAGIC ||
+		header->version != SAVE_HEADER_VERSION)
+		return false;
+
+	// names are printed as they are, a corrupted header must not make them run past their buffers
+	for (int i = 0; i < MAX_PLAYERS; i++)
+		header->players[i][GIOCATORE_NAME_LEN] = '\0';
+	header->winner[GIOCATORE_NAME_LEN] = '\0';
+	return header->n_players >= MIN_PLAYERS && header->n_players <= MAX_PLAYERS;
+}
+
+/**
+ * @brief reads only the metadata header of a save, without loading the whole game
+ * 
+ * @param save_path relative path of the save
+ * @param header pointer to header to be read into (out parameter)
+ * @return true if the save exists and has a valid metadata header
+ * @return false if the save couldn't be opened or is a legacy save without metadata header
+ */
+bool read_save_header(const char *save_path, save_headerT *header) {
+	bool valid;
+	FILE *fp = fopen(save_path, "rb"); // open binary file for reading
+
+	if (fp == NULL)
+		return false;
+
+	setvbuf(fp, NULL, _IONBF, 0); // only the header is needed, avoid filling a whole stdio buffer with game data
+	valid = read_header(fp, header);
+
+	fclose(fp);
+	return valid;
+}
+
 /**
  * @brief loads saved game from a given save name
  * 
  * @param save_name name of the save file wanting to load (without extension) located in SAVES_DIRECTORY
+ * @param options command-line options (log level and categories)
  * @return game_contextT* newly created game context or NULL if given save name couldn't be loaded
  */
-game_contextT *load_game(const char *save_name) {
+game_contextT *load_game(const char *save_name, const launch_optionsT *options) {
 	FILE *fp;
 	game_contextT *game_ctx;
 	giocatoreT *curr_player = NULL;
+	save_headerT header;
 
 	if (!valid_save_name(save_name)) {
 		printf("Nome salvataggio invalido (%s)!\n", save_name);
@@ -172,11 +216,17 @@ game_contextT *load_game(const char *save_name) {
 		return NULL;
 	}
 
-	// save save-name in cache after successfully opening it
-	cache_save_name(game_ctx->save_path);
+	// register save access in the saves catalog after successfully opening it
+	register_save(game_ctx->save_path);
+
+	init_logging(game_ctx, options);
+	LOG_VALUE(game_ctx, LOG_LEVEL_SESSION, LOG_CAT_SESSION, LOG_EV_LOAD_GAME, NULL, 0);
 
-	init_logging(game_ctx);
-	fprintf(game_ctx->log_file, "Caricamento partita da '%s'...\n", game_ctx->save_path);
+	// saves written by this game start with a metadata header, legacy saves (specs format) start directly with players count.
+	// the players are read from the game data, so a header is skipped even if its players count is invalid
+	header.magic = 0;
+	if (!read_header(fp, &header) && (header.magic != SAVE_HEADER_MAGIC || header.version != SAVE_HEADER_VERSION))
+		rewind(fp);
 
 	game_ctx->n_players = read_bin_int(fp);
 
@@ -187,6 +237,7 @@ game_contextT *load_game(const char *save_name) {
 			curr_player = curr_player->next = load_player(fp);
 	}
 	curr_player->next = game_ctx->curr_player; // make the linked list circular linking tail to head
+	log_players(game_ctx);
 
 	game_ctx->mazzo_pesca = load_cards(fp);
 	game_ctx->mazzo_scarti = load_cards(fp);
@@ -261,19 +312,54 @@ void dump_player(FILE *fp, giocatoreT *player) {
 	dump_cards(fp, player->bonus_malus); // save bonus/malus
 }
 
+/**
+ * @brief writes the save metadata header to file
+ * 
+ * @param fp file stream
+ * @param header pointer to header to dump
+ */
+void dump_header(FILE *fp, save_headerT *header) {
+	if (fwrite(header, sizeof(save_headerT), ONE_ELEMENT, fp) != ONE_ELEMENT)
+		file_write_failed();
+}
+
+/**
+ * @brief fills a save metadata header with the current game state summary
+ * 
+ * @param game_ctx current game state
+ * @param header pointer to header to fill (out parameter)
+ */
+void build_header(game_contextT *game_ctx, save_headerT *header) {
+	giocatoreT *player = game_ctx->curr_player;
+
+	memset(header, 0, sizeof(save_headerT)); // avoid dumping uninitialized bytes
+	header->magic = SAVE_HEADER_MAGIC;
+	header->version = SAVE_HEADER_VERSION;
+	header->n_players = game_ctx->n_players;
+	header->round_num = game_ctx->round_num;
+	header->timestamp = (long long)time(NULL);
+	// players are listed in the same order they are dumped in the save
+	for (int i = 0; i < game_ctx->n_players; i++, player = player->next)
+		strncpy(header->players[i], player->name, sizeof(header->players[i]));
+}
+
 /**
  * @brief saves the current game state into the save path
  * 
  * @param game_ctx current game state
  */
 void save_game(game_contextT *game_ctx) {
+	save_headerT header;
 	FILE *fp = fopen(game_ctx->save_path, "wb"); // open binary file for writing
 	if (fp == NULL) {
 		fprintf(stderr, "Opening save file (%s) failed!\n", game_ctx->save_path);
 		exit(EXIT_FAILURE);
 	}
 
-	log_s(game_ctx, "Salvataggio su '%s' in corso...", game_ctx->save_path);
+	LOG_EVENT(game_ctx, LOG_LEVEL_ROUND, LOG_CAT_ROUND, LOG_EV_SAVE, game_ctx->curr_player, NULL, NULL, NULL, ALL, NULL);
+
+	build_header(game_ctx, &header);
+	dump_header(fp, &header);
 
 	write_bin_int(fp, game_ctx->n_players);
 	for (int i = 0; i < game_ctx->n_players; i++, game_ctx->curr_player = game_ctx->curr_player->next)
@@ -289,90 +375,200 @@ void save_game(game_contextT *game_ctx) {
 }
 
 /**
- * @brief parses effects array from the given file stream
+ * @brief marks the save of the current game as won by the current player, rewriting only its metadata header in place
  * 
- * @param fp file stream
- * @param n_effects number of parsed effects
- * @return effettoT* pointer to heap-allocated array containing the parsed effects
+ * @param game_ctx current game state
  */
-effettoT *read_effetti(FILE *fp, int *n_effects) {
-	int amount = read_int(fp);
-	effettoT *effects = NULL;
-	if (amount != 0)
-		effects = (effettoT*)malloc_checked(amount*sizeof(effettoT));
-	for (int i = 0; i < amount; i++) {
-		effects[i].azione = (azioneT)read_int(fp);
-		effects[i].target_giocatori = (target_giocatoriT)read_int(fp);
-		effects[i].target_carta = (tipo_cartaT)read_int(fp);
+void save_game_winner(game_contextT *game_ctx) {
+	save_headerT header;
+	FILE *fp = fopen(game_ctx->save_path, "rb+"); // open binary file for reading and writing
+
+	if (fp == NULL) {
+		fprintf(stderr, "Opening save file (%s) failed!\n", game_ctx->save_path);
+		exit(EXIT_FAILURE);
 	}
-	*n_effects = amount;
-	return effects;
+
+	if (read_header(fp, &header)) { // legacy saves have no header to update
+		strncpy(header.winner, game_ctx->curr_player->name, sizeof(header.winner));
+		header.timestamp = (long long)time(NULL);
+		rewind(fp);
+		dump_header(fp, &header);
+	}
+
+	fclose(fp);
 }
 
 /**
- * @brief reads a card from fp returning its amount aswell. chains the read card onto the current linked list (trough tail_next pointer).
+ * @brief combines a deck file path into the path of its compiled cache, replacing its extension with DECK_CACHE_EXTENSION
  * 
- * @param fp file stream
- * @param tail_next pointer to the current tail's next pointer
- * @param amount out parameter containing the number of cards like this present (count of duplicates+1), 0 if no more cards are readable
- * @return cartaT* the new linked list tail
+ * @param deck_path path of the deck text file
+ * @return char* heap-allocated string containing the cache path
  */
-cartaT *read_carta(FILE *fp, cartaT **tail_next, int *amount) {
-	if (fscanf(fp, "%d", amount) != ONE_ELEMENT) {
-		*amount = 0;
-		return NULL;
+char *get_deck_cache_path(const char *deck_path) {
+	const char *extension = strrchr(deck_path, '.');
+	size_t stem_len = strlen(deck_path);
+	char *cache_path;
+
+	if (extension != NULL && strpbrk(extension, "/\\") == NULL) // the dot belongs to the file name
+		stem_len = extension - deck_path;
+	cache_path = (char*)malloc_checked(stem_len + sizeof(DECK_CACHE_EXTENSION));
+	memcpy(cache_path, deck_path, stem_len);
+	strcpy(cache_path + stem_len, DECK_CACHE_EXTENSION);
+	return cache_path;
+}
+
+/**
+ * @brief loads the compiled cache of a deck file into the deck table with a single read, if it is up to date with its source.
+ * 
+ * @param deck pointer to already initialized (empty) deck table
+ * @param cache_path path of the compiled cache
+ * @param source expected source info: size, mtime and (only if check_hash) hash of the deck file
+ * @param check_hash compare content hash instead of size and mtime of the deck file
+ * @return true if the cache was valid and has been loaded
+ * @return false if the cache is missing, corrupted or outdated
+ */
+bool load_mazzo_cache(deck_tableT *deck, const char *cache_path, deck_cache_headerT *source, bool check_hash) {
+	deck_cache_headerT header;
+	char *data = NULL, *cursor;
+	long size;
+	bool valid = false;
+	FILE *fp = fopen(cache_path, "rb"); // open binary file for reading
+
+	if (fp == NULL)
+		return false;
+
+	if (fseek(fp, 0, SEEK_END) == 0 && (size = ftell(fp)) >= (long)sizeof(deck_cache_headerT)) {
+		rewind(fp);
+		data = (char*)malloc_checked(size);
+		if (fread(data, size, ONE_ELEMENT, fp) == ONE_ELEMENT) {
+			memcpy(&header, data, sizeof(deck_cache_headerT));
+			valid = header.magic == MAZZO_CACHE_MAGIC && header.version == MAZZO_CACHE_VERSION &&
+				header.card_size == (int)sizeof(cartaT) && header.effect_size == (int)sizeof(effettoT) &&
+				header.n_definitions >= 0 && header.n_definitions <= MAZZO_CACHE_MAX_RECORDS &&
+				header.n_effects >= 0 && header.n_effects <= MAZZO_CACHE_MAX_RECORDS &&
+				header.n_overrides >= 0 && header.n_overrides <= MAZZO_CACHE_MAX_RECORDS && header.n_cards >= 0 &&
+				size == (long)(sizeof(deck_cache_headerT) + header.n_definitions*(sizeof(cartaT)+sizeof(int)) +
+					header.n_effects*sizeof(effettoT) + header.n_overrides*sizeof(deck_overrideT));
+			if (check_hash)
+				valid = valid && header.source_hash == source->source_hash;
+			else
+				valid = valid && header.source_size == source->source_size && header.source_mtime == source->source_mtime;
+		}
 	}
-	
-	cartaT *card = (cartaT*)calloc_checked(ONE_ELEMENT, sizeof(cartaT));
+	fclose(fp);
 
-	if (fscanf(fp, " %" TO_STRING(CARTA_NAME_LEN) "[^\n]", card->name) != ONE_ELEMENT)
-		file_read_failed();
-	if (fscanf(fp, " %" TO_STRING(CARTA_DESCRIPTION_LEN) "[^\n]", card->description) != ONE_ELEMENT)
-		file_read_failed();
+	if (valid) {
+		reserve_deck_table(deck, header.n_definitions, header.n_effects, header.n_overrides);
+		cursor = data + sizeof(deck_cache_headerT);
+		memcpy(deck->definitions, cursor, header.n_definitions*sizeof(cartaT));
+		cursor += header.n_definitions*sizeof(cartaT);
+		memcpy(deck->amounts, cursor, header.n_definitions*sizeof(int));
+		cursor += header.n_definitions*sizeof(int);
+		memcpy(deck->effects, cursor, header.n_effects*sizeof(effettoT));
+		cursor += header.n_effects*sizeof(effettoT);
+		memcpy(deck->overrides, cursor, header.n_overrides*sizeof(deck_overrideT));
+		deck->n_definitions = header.n_definitions;
+		deck->n_effects = header.n_effects;
+		deck->n_overrides = header.n_overrides;
+		deck->n_cards = header.n_cards;
+		link_deck_effects(deck); // dumped effetti pointers are meaningless
+		source->source_hash = header.source_hash;
+	}
+	free_wrap(data);
+	return valid;
+}
 
-	card->tipo = (tipo_cartaT)read_int(fp);
-	card->effetti = read_effetti(fp, &card->n_effetti);
-	card->quando = (quandoT)read_int(fp);
-	card->opzionale = read_int(fp) != 0;
+/**
+ * @brief writes the deck table into its compiled cache. failing to write the cache isn't an error, as it is only an optimization
+ * 
+ * @param deck pointer to the deck table
+ * @param cache_path path of the compiled cache
+ * @param source source info: size, mtime and hash of the deck file
+ */
+void save_mazzo_cache(deck_tableT *deck, const char *cache_path, deck_cache_headerT *source) {
+	deck_cache_headerT header = *source;
+	bool written;
+	FILE *fp = fopen(cache_path, "wb"); // open binary file for writing
 
-	// always add first copy to the linked list
-	*tail_next = card;
-	// add additional copies
-	for (int i = 1; i < *amount; i++) // start from 1 as the first one has already been added to the linked list
-		card = card->next = duplicate_carta(card);
+	if (fp == NULL)
+		return;
 
-	// set last allocated card's next ptr to NULL and return the new linked list tail
-	card->next = NULL;
-	return card;
+	header.magic = MAZZO_CACHE_MAGIC;
+	header.version = MAZZO_CACHE_VERSION;
+	header.card_size = sizeof(cartaT);
+	header.effect_size = sizeof(effettoT);
+	header.n_definitions = deck->n_definitions;
+	header.n_effects = deck->n_effects;
+	header.n_overrides = deck->n_overrides;
+	header.n_cards = deck->n_cards;
+
+	written = fwrite(&header, sizeof(deck_cache_headerT), ONE_ELEMENT, fp) == ONE_ELEMENT &&
+		fwrite(deck->definitions, sizeof(cartaT), deck->n_definitions, fp) == (size_t)deck->n_definitions &&
+		fwrite(deck->amounts, sizeof(int), deck->n_definitions, fp) == (size_t)deck->n_definitions &&
+		fwrite(deck->effects, sizeof(effettoT), deck->n_effects, fp) == (size_t)deck->n_effects &&
+		fwrite(deck->overrides, sizeof(deck_overrideT), deck->n_overrides, fp) == (size_t)deck->n_overrides;
+	fclose(fp);
+
+	if (!written)
+		remove(cache_path); // never leave a truncated cache behind
 }
 
 /**
- * @brief loads all the cards from the FILE_MAZZO file
+ * @brief loads every card definition of a deck file into the deck table, using its compiled cache when up to date.
+ * the cache is regenerated when the deck file size or mtime change and its content hash differs.
  * 
- * @param n_cards out parameter containing number of loaded cards
- * @return cartaT* head of the mazzo cards linked list
+ * @param deck pointer to already initialized deck table
+ * @param deck_path path of the deck text file
  */
-cartaT *load_mazzo(int *n_cards) {
-	FILE *fp = fopen(FILE_MAZZO, "r");
-	if (fp == NULL) {
-		fprintf(stderr, "Opening cards file (%s) failed!\n", FILE_MAZZO);
+void load_deck(deck_tableT *deck, const char *deck_path) {
+	struct stat source_stat;
+	deck_cache_headerT source;
+	char *text, *cache_path;
+	size_t length;
+	FILE *fp = fopen(deck_path, "rb"); // binary mode, line endings are handled by the tokenizer
+	if (fp == NULL || stat(deck_path, &source_stat) != 0) {
+		fprintf(stderr, "Opening cards file (%s) failed!\n", deck_path);
 		exit(EXIT_FAILURE);
 	}
 
-	*n_cards = 0;
-	cartaT *mazzo = NULL, **tail_next = &mazzo, *new_tail;
-	int amount;
-	do {
-		new_tail = read_carta(fp, tail_next, &amount);
-		if (amount != 0) {
-			tail_next = &new_tail->next;
-			*n_cards += amount;
-		}
-	} while (amount != 0);
+	cache_path = get_deck_cache_path(deck_path);
+
+	memset(&source, 0, sizeof(deck_cache_headerT));
+	source.source_size = (long long)source_stat.st_size;
+	source.source_mtime = (long long)source_stat.st_mtime;
+
+	// fast path: deck file wasn't touched since the cache was compiled
+	if (!load_mazzo_cache(deck, cache_path, &source, false)) {
+		// deck file was touched: read it whole with a single read and hash its content to check if it actually changed
+		text = (char*)malloc_checked(source_stat.st_size+1);
+		length = fread(text, 1, source_stat.st_size, fp);
+		if (ferror(fp))
+			file_read_failed();
+		source.source_hash = hash_bytes(text, length);
+
+		if (!load_mazzo_cache(deck, cache_path, &source, true))
+			parse_deck(deck, text, length, deck_path);
+		save_mazzo_cache(deck, cache_path, &source); // store new source info (and new definitions if parsed)
+		free_wrap(text);
+	}
 
+	free_wrap(cache_path);
 	fclose(fp);
+}
+
+/**
+ * @brief loads a deck file (through its compiled cache when possible) as a pack of the deck table, see deck_merge_pack
+ * 
+ * @param deck pointer to the merged deck table
+ * @param deck_path path of the deck text file, usually FILE_MAZZO or an expansion pack
+ */
+void load_mazzo_pack(deck_tableT *deck, const char *deck_path) {
+	deck_tableT pack;
 
-	return mazzo;
+	init_deck_table(&pack);
+	load_deck(&pack, deck_path);
+	deck_merge_pack(deck, &pack, deck_path);
+	clear_deck_table(&pack);
 }
 
 /**
@@ -381,7 +577,7 @@ cartaT *load_mazzo(int *n_cards) {
  * @return FILE* log file stream
  */
 FILE *open_log_append(void) {
-	FILE *fp = fopen(FILE_LOG, "a");
+	FILE *fp = fopen(FILE_LOG, "ab+"); // binary append, readable to take the shared lock of a session
 	if (fp == NULL) {
 		fprintf(stderr, "Opening logs file (%s) failed!\n", FILE_LOG);
 		exit(EXIT_FAILURE);
@@ -390,46 +586,412 @@ FILE *open_log_append(void) {
 }
 
 /**
- * @brief loads the saves name cache from FILE_SAVES_CACHE file (creates it if it doesn't exist) into saves multiline
+ * @brief combines a segment number into the path of a rotated log file
+ * 
+ * @param segment segment number, 1 is the most recent rotated segment
+ * @param compressed path of the compressed segment?
+ * @return char* heap-allocated string containing the path of the segment
+ */
+char *get_log_segment_path(int segment, bool compressed) {
+	return format_alloc(compressed ? LOG_SEGMENT_FORMAT LOG_COMPRESSED_EXTENSION : LOG_SEGMENT_FORMAT, segment);
+}
+
+/**
+ * @brief moves a rotated log segment (compressed or not) to another segment number, or removes it
+ * 
+ * @param segment segment to move
+ * @param new_segment new segment number, 0 to remove the segment
+ */
+void shift_log_segment(int segment, int new_segment) {
+	char *path, *new_path;
+
+	for (int compressed = 0; compressed <= 1; compressed++) {
+		path = get_log_segment_path(segment, compressed);
+		if (new_segment == 0)
+			remove(path); // fails harmlessly if the segment doesn't exist
+		else {
+			new_path = get_log_segment_path(new_segment, compressed);
+			rename(path, new_path);
+			free_wrap(new_path);
+		}
+		free_wrap(path);
+	}
+}
+
+/**
+ * @brief rotates the log file: rotated segments are shifted by one (the oldest is removed) and the log file becomes
+ * segment 1. only called by open_log_session holding the exclusive lock of the log file, so no other session is
+ * writing to it (or to the segments, being compressed)
+ * 
+ * @param n_segments rotated segments kept
+ * @return true if the log file was rotated into segment 1 (which is uncompressed)
+ * @return false if the log file was removed instead, or could not be renamed
+ */
+bool rotate_log_file(int n_segments) {
+	char *path;
+	bool rotated;
+
+	shift_log_segment(n_segments, 0);
+	for (int segment = n_segments-1; segment >= 1; segment--)
+		shift_log_segment(segment, segment+1);
+
+	if (n_segments == 0) {
+		remove(FILE_LOG); // no segment kept: the log file just starts over
+		rotated = false;
+	} else {
+		path = get_log_segment_path(1, false);
+		rotated = rename(FILE_LOG, path) == 0;
+		free_wrap(path);
+	}
+	return rotated;
+}
+
+/**
+ * @brief checks if a stream is still open on the log file, and not on a segment it was rotated into (or on a removed
+ * log file) by another session
+ * 
+ * @param fp log file stream
+ * @return true if the stream is open on FILE_LOG (always on Windows, where there are no inode numbers)
+ */
+bool is_log_file(FILE *fp) {
+#ifndef _WIN32
+	struct stat file_stat, log_stat;
+	return fstat(fileno(fp), &file_stat) == 0 && stat(FILE_LOG, &log_stat) == 0 &&
+		file_stat.st_dev == log_stat.st_dev && file_stat.st_ino == log_stat.st_ino;
+#else
+	(void)fp;
+	return true;
+#endif
+}
+
+/**
+ * @brief opens the log file of a session, rotating it first once it reached the given size, so a game never spans two
+ * segments. every session holds a shared lock on the log file until it's closed: the log file is rotated only if the
+ * exclusive lock can be taken without waiting, that is if no other session is logging, otherwise the rotation is
+ * skipped for this session (records of running sessions are never moved into a segment, or compressed away)
+ * 
+ * @param max_size log file size triggering the rotation, 0 to never rotate
+ * @param n_segments rotated segments kept
+ * @param rotated whether the log file was rotated into segment 1 (out parameter)
+ * @return FILE* log file stream holding the shared lock
+ */
+FILE *open_log_session(long long max_size, int n_segments, bool *rotated) {
+	FILE *fp = open_log_append();
+	long size;
+
+	*rotated = false;
+	if (max_size > 0 && try_lock_file(fp, FILE_LOCK_WRITE)) {
+		if (fseek(fp, 0, SEEK_END) == 0 && (size = ftell(fp)) >= 0 && (long long)size >= max_size) {
+#ifdef _WIN32
+			fclose(fp); // open files can't be renamed
+#endif
+			*rotated = rotate_log_file(n_segments);
+#ifndef _WIN32
+			fclose(fp); // the exclusive lock is kept until the log file has been rotated
+#endif
+			fp = open_log_append();
+		}
+	}
+	lock_file(fp, FILE_LOCK_READ); // turns the exclusive lock (if kept) into a shared one, without releasing it
+	while (!is_log_file(fp)) { // rotated by another session while waiting for the lock
+		fclose(fp);
+		fp = open_log_append();
+		lock_file(fp, FILE_LOCK_READ);
+	}
+	return fp;
+}
+
+/**
+ * @brief compresses a rotated log segment, replacing it with its compressed version (path followed by
+ * LOG_COMPRESSED_EXTENSION). each byte is xored with the byte at the same offset of the previous record, as adjacent
+ * records share most fields, then runs of zeros are stored as a zero followed by the run length.
+ * the segment is left uncompressed if anything fails, as it is still readable.
  * 
- * @param saves pointer to already initialized freeable_multiline_textT which will contain one save name (without SAVE_PATH_EXTENSION) per line
+ * @param path path of the segment
  */
-void load_saves_cache(freeable_multiline_textT *saves) {
+void compress_log_segment(const char *path) {
+	unsigned char window[sizeof(log_recordT)] = { 0 }; // bytes of the previous record
+	unsigned int magic = LOG_COMPRESSED_MAGIC;
+	size_t pos = 0;
+	int byte, zeros = 0;
+	bool written;
+	char *compressed_path;
+	FILE *in = fopen(path, "rb"), *out;
+
+	if (in == NULL)
+		return;
+	compressed_path = format_alloc("%s" LOG_COMPRESSED_EXTENSION, path);
+	out = fopen(compressed_path, "wb");
+	if (out == NULL) {
+		fclose(in);
+		free_wrap(compressed_path);
+		return;
+	}
+
+	fwrite(&magic, sizeof(magic), ONE_ELEMENT, out);
+	while ((byte = getc(in)) != EOF) {
+		byte ^= window[pos];
+		window[pos] ^= (unsigned char)byte; // window now holds the original byte
+		pos = (pos + 1) % sizeof(log_recordT);
+		if (byte == 0 && zeros < UCHAR_MAX)
+			zeros++;
+		else {
+			if (zeros != 0) {
+				putc(0, out);
+				putc(zeros, out);
+			}
+			zeros = byte == 0 ? 1 : 0;
+			if (byte != 0)
+				putc(byte, out);
+		}
+	}
+	if (zeros != 0) {
+		putc(0, out);
+		putc(zeros, out);
+	}
+
+	written = !ferror(in) && !ferror(out);
+	fclose(in);
+	written = fclose(out) == 0 && written;
+	remove(written ? path : compressed_path); // keep a single version of the segment
+	free_wrap(compressed_path);
+}
+
+/**
+ * @brief call this when the saves catalog can't be opened, likely because SAVES_DIRECTORY doesn't exist. does not return.
+ * 
+ */
+void saves_catalog_failed(void) {
+	fprintf(stderr, "Opening saves catalog file (%s) failed!\nAssicurati che la cartella '%s' esista e se non esiste creala!\n",
+		SAVES_DIRECTORY FILE_SAVES_CATALOG, SAVES_DIRECTORY);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief imports the save names of the legacy FILE_SAVES_CACHE file (if present) into the catalog
+ * 
+ * @param catalog pointer to already initialized saves catalog
+ */
+void migrate_saves_cache(saves_catalogT *catalog) {
 	char save_name[SAVE_NAME_LEN+1];
 	FILE *fp = fopen(SAVES_DIRECTORY FILE_SAVES_CACHE, "r");
+
+	if (fp != NULL) {
+		// legacy cache has no access times, keep its order (last line is the most recent one)
+		while (fscanf(fp, " %" TO_STRING(SAVE_NAME_LEN) "[^\n]", save_name) == ONE_ELEMENT)
+			catalog_touch(catalog, save_name, 0);
+		fclose(fp);
+	}
+}
+
+/**
+ * @brief loads the whole saves catalog from FILE_SAVES_CATALOG file replaying each access record into the in-memory index.
+ * creates the catalog file (migrating the legacy saves cache) if it doesn't exist.
+ * 
+ * @param catalog pointer to already initialized saves catalog
+ */
+void load_saves_catalog(saves_catalogT *catalog) {
+	char save_name[SAVE_NAME_LEN+1];
+	long long timestamp;
+	FILE *fp = fopen(SAVES_DIRECTORY FILE_SAVES_CATALOG, "r");
+
 	if (fp == NULL) {
-		// either the cache file doesn't exist or the whole SAVES_DIRECTORY doesn't exist.
-		// try creating the FILE_SAVES_CACHE file to check if directory exists.
-		fp = fopen(SAVES_DIRECTORY FILE_SAVES_CACHE, "w");
-		if (fp == NULL) {
-			fprintf(stderr, "Opening saves cache file (%s) failed!\nAssicurati che la cartella '%s' esista e se non esiste creala!\n",
-				SAVES_DIRECTORY FILE_SAVES_CACHE, SAVES_DIRECTORY);
-			exit(EXIT_FAILURE);
-		}
+		// either the catalog doesn't exist yet or the whole SAVES_DIRECTORY doesn't exist.
+		migrate_saves_cache(catalog);
+		save_saves_catalog(catalog); // creates the catalog, checking that the directory exists
 	} else {
-		while (fscanf(fp, " %" TO_STRING(SAVE_NAME_LEN) "[^\n]", save_name) > 0)
-			multiline_addline(saves, strdup_checked(save_name));
+		while (fscanf(fp, "%lld %" TO_STRING(SAVE_NAME_LEN) "[^\n]", &timestamp, save_name) == 2)
+			catalog_touch(catalog, save_name, timestamp);
+		fclose(fp);
+	}
+}
+
+/**
+ * @brief loads the most recently used saves from the FILE_SAVES_RECENT file, reading at most SAVES_MENU_COUNT records
+ * instead of the whole catalog. if the file is missing or invalid, it is rebuilt loading and compacting the whole catalog
+ * (the catalog then holds every save, from the most recently used one)
+ * 
+ * @param catalog pointer to already initialized saves catalog
+ * @return long size of the catalog file when it was last compacted
+ */
+long load_recent_saves(saves_catalogT *catalog) {
+	char save_name[SAVE_NAME_LEN+1];
+	long long timestamp;
+	long compacted_size;
+	FILE *fp = fopen(SAVES_DIRECTORY FILE_SAVES_RECENT, "r");
+
+	if (fp == NULL || fscanf(fp, "%ld", &compacted_size) != ONE_ELEMENT) {
+		if (fp != NULL)
+			fclose(fp);
+		load_saves_catalog(catalog);
+		return save_saves_catalog(catalog);
 	}
+	while (fscanf(fp, "%lld %" TO_STRING(SAVE_NAME_LEN) "[^\n]", &timestamp, save_name) == 2)
+		catalog_touch(catalog, save_name, timestamp);
 	fclose(fp);
+	return compacted_size;
+}
+
+/**
+ * @brief writes the access records of the most recently used saves of the catalog, from the least recently used one so
+ * that reloading them rebuilds the same MRU order
+ * 
+ * @param fp text file stream
+ * @param catalog pointer to saves catalog
+ * @param max_count maximum number of saves to write
+ */
+void write_catalog_records(FILE *fp, saves_catalogT *catalog, int max_count) {
+	int idx = catalog->mru_head;
+
+	for (int count = 1; idx != -1 && count < max_count && catalog->entries[idx].next != -1; count++)
+		idx = catalog->entries[idx].next; // oldest save to write
+	for (; idx != -1; idx = catalog->entries[idx].prev) {
+		if (fprintf(fp, "%lld %s\n", catalog->entries[idx].last_access, catalog->entries[idx].name) < 0)
+			file_write_failed();
+	}
 }
 
 /**
- * @brief saves the given saves name into the FILE_SAVES_CACHE file
+ * @brief rewrites the FILE_SAVES_RECENT file: the size of the catalog file at its last compaction, followed by the access
+ * records of the most recently used saves
  * 
- * @param saves pointer to freeable_multiline_textT containing one save name (without SAVE_PATH_EXTENSION) per line
+ * @param catalog pointer to saves catalog
+ * @param compacted_size size of the catalog file when it was last compacted
  */
-void save_saves_cache(freeable_multiline_textT *saves) {
-	FILE *fp = fopen(SAVES_DIRECTORY FILE_SAVES_CACHE, "w");
+void save_recent_saves(saves_catalogT *catalog, long compacted_size) {
+	FILE *fp = fopen(SAVES_DIRECTORY FILE_SAVES_RECENT, "w");
+	if (fp == NULL)
+		saves_catalog_failed();
+
+	if (fprintf(fp, "%ld\n", compacted_size) < 0)
+		file_write_failed();
+	write_catalog_records(fp, catalog, SAVES_MENU_COUNT);
+
+	if (fclose(fp) != 0)
+		file_write_failed();
+}
+
+/**
+ * @brief appends an access record of a save to the FILE_SAVES_CATALOG file without reading the catalog, then moves the
+ * save to the front of the FILE_SAVES_RECENT file. the catalog is read and compacted only once it has grown to twice
+ * its size after the last compaction, so each access costs a constant amount of records on average
+ * 
+ * @param save_name accessed save name (without SAVE_PATH_EXTENSION)
+ * @param timestamp access time
+ */
+void append_saves_catalog(const char *save_name, long long timestamp) {
+	saves_catalogT catalog;
+	long size, compacted_size;
+	FILE *fp = fopen(SAVES_DIRECTORY FILE_SAVES_CATALOG, "r+"); // unlike "a" mode, doesn't create the file
 	if (fp == NULL) {
-		// the SAVES_DIRECTORY directory doesn't exist.
-		fprintf(stderr, "Opening saves cache file (%s) failed!\nAssicurati che la cartella '%s' esista e se non esiste creala!\n",
-			SAVES_DIRECTORY FILE_SAVES_CACHE, SAVES_DIRECTORY);
-		exit(EXIT_FAILURE);
-	} else {
-		for (int i = 0; i < saves->n_lines; i++)
-			fprintf(fp, "%s\n", saves->lines[i]);
+		// first access ever: create the catalog migrating the legacy saves cache before appending to it
+		init_catalog(&catalog);
+		load_saves_catalog(&catalog);
+		clear_catalog(&catalog);
+		fp = fopen(SAVES_DIRECTORY FILE_SAVES_CATALOG, "r+");
+		if (fp == NULL)
+			saves_catalog_failed();
 	}
+	fseek(fp, 0, SEEK_END);
+	if (fprintf(fp, "%lld %s\n", timestamp, save_name) < 0)
+		file_write_failed();
+	size = ftell(fp);
 	fclose(fp);
+
+	init_catalog(&catalog);
+	compacted_size = load_recent_saves(&catalog);
+	catalog_touch(&catalog, save_name, timestamp);
+	if (size >= CATALOG_COMPACT_MIN_SIZE && size > 2*compacted_size) {
+		// stale records (older accesses to the same saves) may dominate the catalog
+		clear_catalog(&catalog);
+		init_catalog(&catalog);
+		load_saves_catalog(&catalog);
+		save_saves_catalog(&catalog);
+	} else
+		save_recent_saves(&catalog, compacted_size);
+	clear_catalog(&catalog);
+}
+
+/**
+ * @brief rewrites the FILE_SAVES_CATALOG file compacted, with only the last access record of each save, and the
+ * FILE_SAVES_RECENT file with its most recently used saves
+ * 
+ * @param catalog pointer to saves catalog
+ * @return long size of the compacted catalog file
+ */
+long save_saves_catalog(saves_catalogT *catalog) {
+	long size;
+	FILE *fp = fopen(SAVES_DIRECTORY FILE_SAVES_CATALOG, "w");
+	if (fp == NULL)
+		saves_catalog_failed();
+
+	write_catalog_records(fp, catalog, catalog->n_entries);
+	size = ftell(fp);
+	fclose(fp);
+
+	save_recent_saves(catalog, size);
+	return size;
+}
+
+/**
+ * @brief takes an advisory lock on the whole file, or releases it (flushing the stream first, so that other processes
+ * read what was written under the lock). every game process locks the shared files it updates, so that games running
+ * at the same time never interleave their updates. advisory locks aren't available on Windows, where files are left
+ * unlocked
+ * 
+ * @param fp file stream, opened for writing to lock it with FILE_LOCK_WRITE
+ * @param lock lock to take, or FILE_UNLOCK
+ * @param wait wait for the lock if another process holds a conflicting one?
+ * @return true if the lock was taken (or released)
+ * @return false if another process holds a conflicting lock, only without waiting
+ */
+bool set_file_lock(FILE *fp, file_lockT lock, bool wait) {
+#ifndef _WIN32
+	static const short types[] = {
+		[FILE_UNLOCK] = F_UNLCK,
+		[FILE_LOCK_READ] = F_RDLCK,
+		[FILE_LOCK_WRITE] = F_WRLCK
+	};
+	struct flock region = { .l_type = types[lock], .l_whence = SEEK_SET, .l_start = 0, .l_len = 0 }; // to the end, even past it
+
+	if (lock == FILE_UNLOCK && fflush(fp) != 0)
+		file_write_failed();
+	while (fcntl(fileno(fp), wait ? F_SETLKW : F_SETLK, &region) == -1) {
+		if (!wait && (errno == EACCES || errno == EAGAIN))
+			return false;
+		if (errno != EINTR) { // not interrupted by a signal (e.g. the terminal being resized)
+			fprintf(stderr, "Locking file failed!\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+#else
+	(void)fp;
+	(void)lock;
+	(void)wait;
+#endif
+	return true;
+}
+
+/**
+ * @brief waits for an advisory lock on the whole file, or releases it (see set_file_lock)
+ * 
+ * @param fp file stream, opened for writing to lock it with FILE_LOCK_WRITE
+ * @param lock lock to take, or FILE_UNLOCK
+ */
+void lock_file(FILE *fp, file_lockT lock) {
+	set_file_lock(fp, lock, true);
+}
+
+/**
+ * @brief takes an advisory lock on the whole file only if no other process holds a conflicting one (see set_file_lock)
+ * 
+ * @param fp file stream, opened for writing to lock it with FILE_LOCK_WRITE
+ * @param lock lock to take
+ * @return true if the lock was taken (always on Windows)
+ * @return false if another process holds a conflicting lock
+ */
+bool try_lock_file(FILE *fp, file_lockT lock) {
+	return set_file_lock(fp, lock, false);
 }
 
 /**
@@ -440,7 +1002,7 @@ void save_saves_cache(freeable_multiline_textT *saves) {
 FILE *open_stats_read(void) {
 	FILE *fp = fopen(FILE_STATS, "rb"); // open binary file for reading
 	if (fp == NULL) { // stats file doesn't exist
-		fp = fopen(FILE_STATS, "wb"); // open binary file for writing
+		fp = fopen(FILE_STATS, "ab"); // create it without truncating it, another game could have just created and written it
 		if (fp != NULL) { // file created successfully
 			fclose(fp);
 			fp = fopen(FILE_STATS, "rb"); // its a binary file
@@ -493,4 +1055,269 @@ bool read_player_stats(FILE *fp, player_statsT *stats) {
 void write_player_stats(FILE *fp, player_statsT *stats) {
 	if (fwrite(stats, sizeof(player_statsT), ONE_ELEMENT, fp) != ONE_ELEMENT)
 		file_write_failed();
+}
+
+/**
+ * @brief moves a stats file stream to the given record
+ * 
+ * @param fp stats file stream
+ * @param record record number
+ */
+void seek_player_stats(FILE *fp, int record) {
+	if (fseek(fp, (long)record*sizeof(player_statsT), SEEK_SET) != 0)
+		file_read_failed();
+}
+
+/**
+ * @brief moves the stats index stream to the given slot
+ * 
+ * @param store pointer to the stats store (with an index)
+ * @param slot slot number
+ */
+void seek_stats_slot(stats_storeT *store, int slot) {
+	if (fseek(store->index, sizeof(stats_index_headerT) + (long)slot*sizeof(int), SEEK_SET) != 0)
+		file_read_failed();
+}
+
+/**
+ * @brief reads the stats of the given record of the stats store
+ * 
+ * @param store pointer to the stats store
+ * @param record record number
+ * @param stats pointer to player stats struct to be read into (out parameter)
+ */
+void read_stats_record(stats_storeT *store, int record, player_statsT *stats) {
+	seek_player_stats(store->records, record);
+	if (!read_player_stats(store->records, stats))
+		file_read_failed();
+}
+
+/**
+ * @brief rewrites the stats index with the given amount of slots, hashing every record of the stats file (names in the
+ * stats file are unique) and ranking them in the stats summary. failing to write the index isn't an error, as it is
+ * only an optimization: records are scanned instead (the summary is still computed). stores opened only to look up
+ * stats never write the index, as they only hold a shared lock: they just compute the summary and scan the records.
+ * 
+ * @param store pointer to the stats store, its header holds the records count
+ * @param n_slots slots of the index, power of 2 at least twice the records count
+ */
+void build_stats_index(stats_storeT *store, int n_slots) {
+	player_statsT stats;
+	int *slots = (int*)calloc_checked(n_slots, sizeof(int)), slot;
+	bool written;
+
+	memset(store->header.top_records, 0, sizeof(store->header.top_records));
+	memset(store->header.top_values, 0, sizeof(store->header.top_values));
+	seek_player_stats(store->records, 0);
+	for (int record = 0; record < store->header.n_records && read_player_stats(store->records, &stats); record++) {
+		slot = hash_string(stats.name) & (n_slots-1);
+		while (slots[slot] != 0)
+			slot = (slot+1) & (n_slots-1); // linear probing
+		slots[slot] = record+1;
+		update_stats_top(&store->header, record, &stats);
+	}
+
+	store->header.magic = STATS_INDEX_MAGIC;
+	store->header.version = STATS_INDEX_VERSION;
+	store->header.record_size = sizeof(player_statsT);
+	store->header.n_slots = n_slots;
+
+	if (store->index != NULL)
+		fclose(store->index);
+	store->index = store->write ? fopen(FILE_STATS_INDEX, "wb+") : NULL; // open binary file for reading and writing, truncating it
+	if (store->index == NULL) {
+		free_wrap(slots);
+		return;
+	}
+	written = fwrite(&store->header, sizeof(stats_index_headerT), ONE_ELEMENT, store->index) == ONE_ELEMENT &&
+		fwrite(slots, sizeof(int), n_slots, store->index) == (size_t)n_slots &&
+		fflush(store->index) == 0;
+	free_wrap(slots);
+
+	if (!written) {
+		fclose(store->index);
+		store->index = NULL;
+		remove(FILE_STATS_INDEX); // never leave a truncated index behind
+	}
+}
+
+/**
+ * @brief rebuilds the stats index for the records count in the header of the store, with enough slots to keep it at
+ * most half full
+ * 
+ * @param store pointer to the stats store
+ */
+void rebuild_stats_index(stats_storeT *store) {
+	int n_slots = STATS_INDEX_MIN_SLOTS;
+
+	while (n_slots < 2*store->header.n_records)
+		n_slots *= 2;
+	build_stats_index(store, n_slots);
+}
+
+/**
+ * @brief takes the lock of the stats store (exclusive if it was opened for writing, shared otherwise) or releases it.
+ * the index is only written under the exclusive lock, so both files are guarded by the lock of the stats file
+ * 
+ * @param store pointer to the stats store
+ * @param locked true to take the lock, false to release it
+ */
+void lock_stats_store(stats_storeT *store, bool locked) {
+	lock_file(store->records, !locked ? FILE_UNLOCK : store->write ? FILE_LOCK_WRITE : FILE_LOCK_READ);
+}
+
+/**
+ * @brief opens the stats file together with its hash index, rebuilding the index if it's missing or doesn't match the
+ * stats file (e.g. it was written by an older version, or the game was interrupted while saving stats). the store is
+ * locked until it's closed, so it should be kept open only for a few reads and writes
+ * 
+ * @param store pointer to the stats store to open (out parameter)
+ * @param write true to update the stats, false to only look them up
+ */
+void open_stats_store(stats_storeT *store, bool write) {
+	long size, index_size;
+	bool valid = false;
+
+	store->write = write;
+	store->records = write ? open_stats_read_write() : open_stats_read();
+	lock_stats_store(store, true);
+	if (fseek(store->records, 0, SEEK_END) != 0 || (size = ftell(store->records)) < 0)
+		file_read_failed();
+
+	store->index = fopen(FILE_STATS_INDEX, write ? "rb+" : "rb"); // open binary file for reading (and writing)
+	if (store->index != NULL && fseek(store->index, 0, SEEK_END) == 0 && (index_size = ftell(store->index)) >= (long)sizeof(stats_index_headerT)) {
+		rewind(store->index);
+		valid = fread(&store->header, sizeof(stats_index_headerT), ONE_ELEMENT, store->index) == ONE_ELEMENT &&
+			store->header.magic == STATS_INDEX_MAGIC && store->header.version == STATS_INDEX_VERSION &&
+			store->header.record_size == (int)sizeof(player_statsT) &&
+			(long)store->header.n_records*(long)sizeof(player_statsT) == size &&
+			store->header.n_slots >= STATS_INDEX_MIN_SLOTS && store->header.n_slots >= 2*store->header.n_records &&
+			(store->header.n_slots & (store->header.n_slots-1)) == 0 &&
+			index_size == (long)(sizeof(stats_index_headerT) + store->header.n_slots*sizeof(int));
+	}
+
+	if (!valid) {
+		store->header.n_records = size / sizeof(player_statsT);
+		rebuild_stats_index(store);
+	}
+}
+
+/**
+ * @brief closes the stats file and its index, releasing the lock of the store
+ * 
+ * @param store pointer to the stats store
+ */
+void close_stats_store(stats_storeT *store) {
+	if (store->index != NULL)
+		fclose(store->index);
+	fclose(store->records); // flushes the records before the lock is released
+}
+
+/**
+ * @brief looks up the stats of a player through the stats index, reading only the records hashed near it (or scanning
+ * the stats file if there is no index)
+ * 
+ * @param store pointer to the stats store
+ * @param name player name
+ * @param stats pointer to player stats struct to be read into (out parameter)
+ * @param slot slot of the player in the index, or the empty one where it should be inserted (out parameter)
+ * @return int record number of the player stats, -1 if the player doesn't have stats yet
+ */
+int find_player_stats(stats_storeT *store, const char *name, player_statsT *stats, int *slot) {
+	int found = -1, record = 0;
+
+	if (store->index == NULL) {
+		seek_player_stats(store->records, 0);
+		for (; found == -1 && read_player_stats(store->records, stats); record++) {
+			if (!strncmp(stats->name, name, GIOCATORE_NAME_LEN))
+				found = record;
+		}
+		return found;
+	}
+
+	*slot = hash_string(name) & (store->header.n_slots-1);
+	seek_stats_slot(store, *slot);
+	while (found == -1 && (record = read_bin_int(store->index)-1) != -1) {
+		read_stats_record(store, record, stats);
+		if (!strncmp(stats->name, name, GIOCATORE_NAME_LEN))
+			found = record;
+		else {
+			*slot = (*slot+1) & (store->header.n_slots-1); // linear probing
+			seek_stats_slot(store, *slot);
+		}
+	}
+	return found;
+}
+
+/**
+ * @brief writes the stats of a player into the stats store, overwriting their record or appending a new one (which is
+ * inserted in the index, doubling it when it gets half full), and updates the stats summary
+ * 
+ * @param store pointer to the stats store, opened for writing
+ * @param stats_update updated player stats
+ * @param record record of the player returned by find_player_stats, -1 to append a new one
+ * @param slot slot of the player returned by find_player_stats
+ */
+void put_player_stats(stats_storeT *store, player_statsT *stats_update, int record, int slot) {
+	bool append = record == -1;
+
+	if (append)
+		record = store->header.n_records++;
+	seek_player_stats(store->records, record);
+	write_player_stats(store->records, stats_update);
+	if (fflush(store->records) != 0) // the index must only refer to records already in the stats file
+		file_write_failed();
+
+	if (!update_stats_top(&store->header, record, stats_update) || (append && 2*store->header.n_records > store->header.n_slots))
+		build_stats_index(store, 2*store->header.n_records > store->header.n_slots ? store->header.n_slots*2 : store->header.n_slots);
+	else if (store->index != NULL) {
+		if (append) {
+			seek_stats_slot(store, slot);
+			write_bin_int(store->index, record+1);
+		}
+		if (fseek(store->index, 0, SEEK_SET) != 0 || fwrite(&store->header, sizeof(stats_index_headerT), ONE_ELEMENT, store->index) != ONE_ELEMENT)
+			file_write_failed();
+	}
+}
+
+/**
+ * @brief appends the record of a finished game to the FILE_HISTORY file, creating it with its header if it doesn't
+ * exist. the history is only used for analytics, so a history written with a different record layout is left untouched
+ * (and the record isn't appended) instead of terminating the game.
+ * 
+ * @param record record of the game
+ */
+void append_game_record(game_recordT *record) {
+	history_headerT header = { .magic = HISTORY_MAGIC, .version = HISTORY_VERSION, .record_size = sizeof(game_recordT) }, file_header;
+	FILE *fp = fopen(FILE_HISTORY, "ab"); // create the file if it doesn't exist, without truncating it if another game just did
+	long size;
+
+	if (fp != NULL) {
+		fclose(fp);
+		fp = fopen(FILE_HISTORY, "rb+"); // open binary file for reading and writing
+	}
+	if (fp == NULL) {
+		fprintf(stderr, "Opening history file (%s) failed!\n", FILE_HISTORY);
+		exit(EXIT_FAILURE);
+	}
+	lock_file(fp, FILE_LOCK_WRITE); // games ending at the same time append their records one after the other
+	if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0)
+		file_read_failed();
+
+	if (size < (long)sizeof(history_headerT)) { // first game ever recorded
+		rewind(fp);
+		if (fwrite(&header, sizeof(history_headerT), ONE_ELEMENT, fp) != ONE_ELEMENT)
+			file_write_failed();
+		size = sizeof(history_headerT);
+	} else if (fseek(fp, 0, SEEK_SET) != 0 || fread(&file_header, sizeof(history_headerT), ONE_ELEMENT, fp) != ONE_ELEMENT || memcmp(&file_header, &header, sizeof(history_headerT))) {
+		fprintf(stderr, "History file (%s) has a different format, the game isn't recorded!\n", FILE_HISTORY);
+		fclose(fp);
+		return;
+	}
+
+	// a record partially written by an interrupted game is overwritten
+	size -= (size - (long)sizeof(history_headerT)) % (long)sizeof(game_recordT);
+	if (fseek(fp, size, SEEK_SET) != 0 || fwrite(record, sizeof(game_recordT), ONE_ELEMENT, fp) != ONE_ELEMENT)
+		file_write_failed();
+	fclose(fp);
 }
\ No newline at end of file
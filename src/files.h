@@ -4,16 +4,32 @@
 #include "types.h"
 #include "structs.h"
 
-game_contextT *load_game(const char *save_name);
+game_contextT *load_game(const char *save_name, const launch_optionsT *options);
 void save_game(game_contextT *game_ctx);
+void save_game_winner(game_contextT *game_ctx);
+bool read_save_header(const char *save_path, save_headerT *header);
 
-cartaT *load_mazzo(int *n_cards);
+void load_mazzo_pack(deck_tableT *deck, const char *deck_path);
 FILE *open_log_append(void);
+char *get_log_segment_path(int segment, bool compressed);
+bool rotate_log_file(int n_segments);
+FILE *open_log_session(long long max_size, int n_segments, bool *rotated);
+void compress_log_segment(const char *path);
 FILE *open_stats_read(void);
-FILE *open_stats_read_write(void);
 bool read_player_stats(FILE *fp, player_statsT *stats);
-void write_player_stats(FILE *fp, player_statsT *stats);
-void load_saves_cache(freeable_multiline_textT *saves);
-void save_saves_cache(freeable_multiline_textT *saves);
+void lock_file(FILE *fp, file_lockT lock);
+bool try_lock_file(FILE *fp, file_lockT lock);
+void open_stats_store(stats_storeT *store, bool write);
+void rebuild_stats_index(stats_storeT *store);
+void lock_stats_store(stats_storeT *store, bool locked);
+void close_stats_store(stats_storeT *store);
+void read_stats_record(stats_storeT *store, int record, player_statsT *stats);
+int find_player_stats(stats_storeT *store, const char *name, player_statsT *stats, int *slot);
+void put_player_stats(stats_storeT *store, player_statsT *stats_update, int record, int slot);
+void append_game_record(game_recordT *record);
+void load_saves_catalog(saves_catalogT *catalog);
+long load_recent_saves(saves_catalogT *catalog);
+void append_saves_catalog(const char *save_name, long long timestamp);
+long save_saves_catalog(saves_catalogT *catalog);
 
 #endif // FILES_H
\ No newline at end of file
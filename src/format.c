@@ -1,122 +1,204 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
 #include "format.h"
 #include "utils.h"
+#include "frame.h"
 
 /**
  * @brief call this when an error in dynamic formatting happens. does not return.
  * 
  */
 void formatting_failed(void) {
-	fputs("Error occurred while formatting a dynamically allocated string!", stderr);
+	fputs("Error occurred while formatting a string!", stderr);
 	exit(EXIT_FAILURE);
 }
 
+scratch_blockT *scratch_arena = NULL; // newest block of the scratch arena used by format_scratch
+
 /**
- * @brief dynamically formats a string with one integer parameter
+ * @brief formats a string into a caller-supplied buffer (usually on the stack), without any allocation.
+ * buffers are sized for their content, so a truncated string is a bug: it doesn't return in that case.
  * 
- * @param strp pointer to formatted string
+ * @param buf buffer receiving the formatted string
+ * @param size size of the buffer
  * @param fmt format string
- * @param d0 param 0 (int)
+ * @param ... format arguments
  * @return int length of formatted string
  */
-int asprintf_d(char **strp, const char *fmt, int d0) {
-	int length, result;
-	if (fmt == NULL)
-		formatting_failed();
-	length = snprintf(NULL, 0, fmt, d0);
-	*strp = malloc_checked(length+1);
-	result = snprintf(*strp, length+1, fmt, d0);
-	if (result < 0)
+int format_buf(char *buf, size_t size, const char *fmt, ...) {
+	va_list args;
+	int length;
+
+	va_start(args, fmt);
+	length = vsnprintf(buf, size, fmt, args);
+	va_end(args);
+	if (length < 0 || (size_t)length >= size)
 		formatting_failed();
-	return result;
+	return length;
 }
 
 /**
- * @brief dynamically formats a string with one string parameter
+ * @brief formats a string into a new heap block, for strings outliving the current frame (e.g. file paths)
  * 
- * @param strp pointer to formatted string
  * @param fmt format string
- * @param s0 param 0 (string)
- * @return int length of formatted string
+ * @param ... format arguments
+ * @return char* heap-allocated formatted string
  */
-int asprintf_s(char **strp, const char *fmt, const char *s0) {
-	int length, result;
-	if (fmt == NULL)
-		formatting_failed();
-	length = snprintf(NULL, 0, fmt, s0);
-	*strp = malloc_checked(length+1);
-	result = snprintf(*strp, length+1, fmt, s0);
-	if (result < 0)
+char *format_alloc(const char *fmt, ...) {
+	va_list args;
+	int length;
+	char *str;
+
+	va_start(args, fmt);
+	length = vsnprintf(NULL, 0, fmt, args);
+	va_end(args);
+	if (length < 0)
 		formatting_failed();
-	return result;
+
+	str = malloc_checked(length+1);
+	va_start(args, fmt);
+	vsnprintf(str, length+1, fmt, args);
+	va_end(args);
+	return str;
 }
 
 /**
- * @brief dynamically formats a string with two string parameter
+ * @brief reserves memory from the scratch arena, adding a block when the newest one is full.
+ * blocks never move, so every string of the frame stays valid until scratch_release.
  * 
- * @param strp pointer to formatted string
- * @param fmt format string
- * @param s0 param 0 (string)
- * @param s1 param 1 (string)
- * @return int length of formatted string
+ * @param size bytes to reserve
+ * @return char* reserved memory
  */
-int asprintf_ss(char **strp, const char *fmt, const char *s0, const char *s1) {
-	int length, result;
-	if (fmt == NULL)
-		formatting_failed();
-	length = snprintf(NULL, 0, fmt, s0, s1);
-	*strp = malloc_checked(length+1);
-	result = snprintf(*strp, length+1, fmt, s0, s1);
-	if (result < 0)
-		formatting_failed();
-	return result;
+char *scratch_alloc(size_t size) {
+	scratch_blockT *block;
+	size_t capacity;
+
+	if (scratch_arena == NULL || scratch_arena->capacity - scratch_arena->used < size) {
+		capacity = size > SCRATCH_BLOCK_SIZE ? size : SCRATCH_BLOCK_SIZE;
+		block = (scratch_blockT*)malloc_checked(sizeof(scratch_blockT) + capacity);
+		block->prev = scratch_arena;
+		block->used = 0;
+		block->capacity = capacity;
+		scratch_arena = block;
+	}
+
+	scratch_arena->used += size;
+	return &scratch_arena->data[scratch_arena->used - size];
 }
 
 /**
- * @brief dynamically formats a string with three string parameter
+ * @brief formats a string into the scratch arena: no allocation unless the frame outgrows the arena.
+ * the string is valid until the scratch_release of the enclosing scratch_mark.
  * 
- * @param strp pointer to formatted string
  * @param fmt format string
- * @param s0 param 0 (string)
- * @param s1 param 1 (string)
- * @param s2 param 2 (string)
- * @return int length of formatted string
+ * @param ... format arguments
+ * @return char* formatted string
  */
-int asprintf_sss(char **strp, const char *fmt, const char *s0, const char *s1, const char *s2) {
-	int length, result;
-	if (fmt == NULL)
-		formatting_failed();
-	length = snprintf(NULL, 0, fmt, s0, s1, s2);
-	*strp = malloc_checked(length+1);
-	result = snprintf(*strp, length+1, fmt, s0, s1, s2);
-	if (result < 0)
+char *format_scratch(const char *fmt, ...) {
+	va_list args;
+	int length;
+	size_t room = scratch_arena != NULL ? scratch_arena->capacity - scratch_arena->used : 0;
+	char *str = scratch_arena != NULL ? &scratch_arena->data[scratch_arena->used] : NULL;
+
+	// try formatting in place first, the string is just claimed if it fits
+	va_start(args, fmt);
+	length = vsnprintf(str, room, fmt, args);
+	va_end(args);
+	if (length < 0)
 		formatting_failed();
-	return result;
+
+	if ((size_t)length < room)
+		return scratch_alloc(length+1);
+
+	str = scratch_alloc(length+1); // doesn't fit: claim a new block and format again
+	va_start(args, fmt);
+	vsnprintf(str, length+1, fmt, args);
+	va_end(args);
+	return str;
 }
 
 /**
- * @brief dynamically formats a string with four string parameter
+ * @brief marks the current position of the scratch arena, call this when a frame starts
  * 
- * @param strp pointer to formatted string
- * @param fmt format string
- * @param s0 param 0 (string)
- * @param s1 param 1 (string)
- * @param s2 param 2 (string)
- * @param s3 param 3 (string)
- * @return int length of formatted string
+ * @return scratch_markT position to release to
  */
-int asprintf_ssss(char **strp, const char *fmt, const char *s0, const char *s1, const char *s2, const char *s3) {
-	int length, result;
-	if (fmt == NULL)
-		formatting_failed();
-	length = snprintf(NULL, 0, fmt, s0, s1, s2, s3);
-	*strp = malloc_checked(length+1);
-	result = snprintf(*strp, length+1, fmt, s0, s1, s2, s3);
-	if (result < 0)
-		formatting_failed();
-	return result;
+scratch_markT scratch_mark(void) {
+	scratch_markT mark = { scratch_arena, scratch_arena != NULL ? scratch_arena->used : 0 };
+	return mark;
+}
+
+/**
+ * @brief releases everything formatted in the scratch arena since the given mark, call this when a frame ends.
+ * blocks added during the frame are freed, except the first one which is kept for the next frames.
+ * 
+ * @param mark position returned by scratch_mark
+ */
+void scratch_release(scratch_markT mark) {
+	scratch_blockT *prev;
+
+	while (scratch_arena != NULL && scratch_arena != mark.block && scratch_arena->prev != NULL) {
+		prev = scratch_arena->prev;
+		free_wrap(scratch_arena);
+		scratch_arena = prev;
+	}
+	if (scratch_arena != NULL)
+		scratch_arena->used = scratch_arena == mark.block ? mark.used : 0;
+}
+
+/**
+ * @brief returns the terminal columns taken by the first len bytes of a string: CSI escape sequences (colors, cursor
+ * movements) take none, every UTF-8 code point takes one. the string is scanned a word at a time: a word without any
+ * ESC byte takes as many columns as its bytes which aren't UTF-8 continuation bytes (10xxxxxx), only words containing
+ * an ESC fall back to a byte-wise scan. no byte past len is read.
+ * 
+ * @param str string
+ * @param len length in bytes of the part of str to measure
+ * @return int columns
+ */
+int text_width(const char *str, size_t len) {
+	const unsigned long long ones = 0x0101010101010101ULL, highs = 0x8080808080808080ULL;
+	unsigned long long word, escapes, continuations;
+	int width = 0;
+	size_t i = 0;
+
+	while (i < len) {
+		escapes = 1; // forces the byte-wise scan when a whole word isn't available
+		if (i+sizeof(word) <= len) {
+			memcpy(&word, str + i, sizeof(word));
+			escapes = word ^ (ones*'\033'); // zero bytes where word has an ESC
+			escapes = (escapes - ones) & ~escapes & highs;
+		}
+		if (!escapes) {
+			continuations = word & ~(word << 1) & highs; // high bit set where a byte is 10xxxxxx
+			width += sizeof(word) - (int)(((continuations >> 7) * ones) >> 56);
+			i += sizeof(word);
+		} else if (str[i] == '\033') { // skip the whole escape sequence
+			i++;
+			if (i < len && str[i] == '[') { // CSI: parameters up to the final byte
+				i++;
+				while (i < len && (str[i] < '@' || str[i] > '~'))
+					i++;
+			}
+			i++; // final byte (or the only byte following ESC)
+		} else {
+			if (((unsigned char)str[i] & 0xC0) != 0x80)
+				width++;
+			i++;
+		}
+	}
+	return width;
+}
+
+/**
+ * @brief returns the terminal columns taken by a string (see text_width)
+ * 
+ * @param str string
+ * @return int columns
+ */
+int string_width(const char *str) {
+	return text_width(str, strlen(str));
 }
 
 /**
@@ -125,7 +207,7 @@ int asprintf_ssss(char **strp, const char *fmt, const char *s0, const char *s1,
  * @param multiline pointer to the multiline
  */
 void init_multiline(multiline_textT *multiline) {
-	multiline->n_lines = 0;
+	multiline->n_lines = multiline->capacity = 0;
 	multiline->lines = NULL;
 	multiline->lengths = NULL;
 }
@@ -153,7 +235,7 @@ void clear_freeable_multiline(freeable_multiline_textT *freeable_multiline) {
 }
 
 /**
- * @brief append a new line to the multiline
+ * @brief append a new line to the multiline, its visual width is stored alongside it
  * 
  * @param multiline pointer to the multiline
  * @param line string to add
@@ -161,125 +243,110 @@ void clear_freeable_multiline(freeable_multiline_textT *freeable_multiline) {
 void multiline_addline(multiline_textT *multiline, const char *line) {
 	// increase arrays sizes
 	multiline->n_lines++;
-	// realloc arrays
-	multiline->lines = realloc_checked(multiline->lines, multiline->n_lines*sizeof(char*));
-	multiline->lengths = realloc_checked(multiline->lengths, multiline->n_lines*sizeof(int));
+	// realloc arrays, doubling their capacity
+	if (multiline->n_lines > multiline->capacity) {
+		multiline->capacity = multiline->capacity == 0 ? MULTILINE_MIN_CAPACITY : multiline->capacity*2;
+		multiline->lines = realloc_checked(multiline->lines, multiline->capacity*sizeof(char*));
+		multiline->lengths = realloc_checked(multiline->lengths, multiline->capacity*sizeof(int));
+	}
 	// add actual line
 	multiline->lines[multiline->n_lines-1] = line;
-	multiline->lengths[multiline->n_lines-1] = strlen(line);
-}
-
-/**
- * @brief append a new line to the multiline specifying its visual length (usedful for pretty printing)
- * 
- * @param multiline pointer to the multiline
- * @param line string to add
- * @param len visual length of the string
- */
-void multiline_addline_with_len(multiline_textT *multiline, const char *line, int len) {
-	multiline_addline(multiline, line);
-	multiline->lengths[multiline->n_lines-1] = len;
+	multiline->lengths[multiline->n_lines-1] = string_width(line);
 }
 
 /**
  * @brief Wrap a string into a wrapped_textT with a specified max width.
- * Works by creating a heap copy of the string and replacing spaces with NULL-terminators for signaling end of each line, thus creating
- * new substrings which are referenced in the wrapped's multiline.
+ * Lines are stored as offset and length spans into the string itself: nothing is copied nor allocated, so the string
+ * must outlive the wrapped (descriptions are wrapped once, see render_card). A word longer than max_width gets a line
+ * of its own.
  * 
  * @param wrapped pointer to the wrapped
  * @param text string to wrap
  * @param max_width maximum width to use in wrapping text
  */
 void wrap_text(wrapped_textT *wrapped, const char *text, size_t max_width) {
-	size_t text_len = strlen(text);
-	init_multiline(&wrapped->multiline);
-
-	// initialize fields
-	wrapped->text = strdup_checked(text); // create a heap copy of text
-	multiline_addline(&wrapped->multiline, wrapped->text); // add initial first line (a substring yet to be terminated in the right spot)
+	size_t text_len = strlen(text), line_start = 0, last_space = 0;
+	wrapped->n_lines = 0;
 
-	char *last_space = wrapped->text;
 	for (size_t pos = 0, line_len = 0, word_len = 0; pos <= text_len; pos++) { // iterate until the NULL-terminator (included)
-		if (wrapped->text[pos] == ' ' || wrapped->text[pos] == '\0') { // only interested in spaces and terminator
-			if (line_len+word_len >= max_width) { // check if this word doesn't fit in the current line withing the max_width
-				// split line into two substrings first
-				*last_space = '\0'; // terminate this line (first substring)
-
-				wrapped->multiline.lengths[wrapped->multiline.n_lines-1] = line_len-1; // save this line's length (remove added space)
-
-				multiline_addline(&wrapped->multiline, last_space+1); // add next line (second substring) to multiline (skipping the space)
-
+		if (text[pos] == ' ' || text[pos] == '\0') { // only interested in spaces and terminator
+			// check if this word doesn't fit in the current line withing the max_width (and the line isn't empty)
+			if (line_len+word_len >= max_width && line_len > 0 && wrapped->n_lines < WRAP_MAX_LINES-1) {
+				// end the line at the last space, the next one starts after it
+				wrapped->lines[wrapped->n_lines].offset = line_start;
+				wrapped->lines[wrapped->n_lines++].length = line_len-1; // remove added space
+				line_start = last_space+1;
 				line_len = 0; // starting a new line
 			}
-			last_space = &wrapped->text[pos]; // update pointer to last encountered space (possible split point of the current line)
+			last_space = pos; // update last encountered space (possible split point of the current line)
 			line_len += word_len+1; // include space
 			word_len = 0; // starting a new word
 		} else
 			word_len++; // just a normal characted of a word, increase word length
 	}
-}
-
-/**
- * @brief free up memory allocated by wrapped_textT structure. must always be called after finished using the wrapped
- * 
- * @param wrapped pointer to wrapped
- */
-void clear_wrapped(wrapped_textT *wrapped) {
-	clear_multiline(&wrapped->multiline);
-	free_wrap(wrapped->text);
+	wrapped->lines[wrapped->n_lines].offset = line_start; // the last line goes up to the end of the string
+	wrapped->lines[wrapped->n_lines++].length = text_len - line_start;
 }
 
 /**
  * @brief centers a string in a specified width and adds left and right borders to it (not included in the width)
  * 
- * @param str string to be centered and boxed
- * @param str_len visual length of str
+ * @param str string to be centered and boxed, can contain colors
  * @param l_border left border string
  * @param r_border right border string
  * @param width width to center str into
- * @return char* formatted centered and boxed string
+ * @return char* formatted centered and boxed string, in the scratch arena
  */
-char *center_lr_boxed_string(const char *str, int str_len, const char *l_border, const char *r_border, int width) {
-	int length, padding = width - str_len;
+char *center_lr_boxed_string(const char *str, const char *l_border, const char *r_border, int width) {
+	int padding = width - string_width(str);
 	int l_padding = padding / 2;
 	int r_padding = padding - l_padding;
-	char *formatted;
-
-	// dynamically allocate the formatted string as asprintf would do
-	length = snprintf(NULL, 0, "%s%*s%s%*s%s", l_border, l_padding, "", str, r_padding, "", r_border);
-	formatted = malloc_checked(length+1);
-	if (snprintf(formatted, length+1, "%s%*s%s%*s%s", l_border, l_padding, "", str, r_padding, "", r_border) < 0)
-		formatting_failed();
 
-	return formatted;
+	return format_scratch("%s%*s%s%*s%s", l_border, l_padding, "", str, r_padding, "", r_border);
 }
 
 /**
  * @brief centers a string in a specified width and adds border to its left and right (not included in the width)
  * 
- * @param str string to be centered and boxed
- * @param str_len visual length of str
+ * @param str string to be centered and boxed, can contain colors
  * @param border border string
  * @param width width to center str into
- * @return char* formatted centered and boxed string
+ * @return char* formatted centered and boxed string, in the scratch arena
  */
-char *center_boxed_string(const char *str, int str_len, const char *border, int width) {
-	return center_lr_boxed_string(str, str_len, border, border, width);
+char *center_boxed_string(const char *str, const char *border, int width) {
+	return center_lr_boxed_string(str, border, border, width);
+}
+
+/**
+ * @brief centers a span of a plain string (no colors) in a specified width and adds border to its left and right (not
+ * included in the width)
+ * 
+ * @param text string the span belongs to
+ * @param span offset and length of the span
+ * @param border border string
+ * @param width width to center the span into
+ * @return char* formatted centered and boxed span, in the scratch arena
+ */
+char *center_boxed_span(const char *text, text_spanT span, const char *border, int width) {
+	int padding = width - span.length;
+	int l_padding = padding / 2;
+	int r_padding = padding - l_padding;
+
+	return format_scratch("%s%*s%.*s%*s%s", border, l_padding, "", span.length, text + span.offset, r_padding, "", border);
 }
 
 /**
  * @brief prints a line with only the centered string in the specified width surrounded left and right by borders (not included in the width)
  * 
- * @param str string to be printed center and boxed
- * @param str_len visual length of str
+ * @param str string to be printed center and boxed, can contain colors
  * @param l_border left border string
  * @param r_border right border string
  * @param width width to center str into
  */
-void print_centered_lr_boxed_string(const char *str, int str_len, const char *l_border, const char *r_border, int width) {
-	char *formatted = center_lr_boxed_string(str, str_len, l_border, r_border, width);
-	puts(formatted);
-	free_wrap(formatted);
+void print_centered_lr_boxed_string(const char *str, const char *l_border, const char *r_border, int width) {
+	scratch_markT mark = scratch_mark();
+	frame_puts(center_lr_boxed_string(str, l_border, r_border, width));
+	scratch_release(mark);
 }
 
 /**
@@ -291,5 +358,5 @@ void print_centered_lr_boxed_string(const char *str, int str_len, const char *l_
  */
 void print_centered_boxed_multiline(multiline_textT *multiline, const char *border, int width) {
 	for (int i = 0; i < multiline->n_lines; i++)
-		print_centered_lr_boxed_string(multiline->lines[i], multiline->lengths[i], border, border, width);
+		print_centered_lr_boxed_string(multiline->lines[i], border, border, width);
 }
@@ -4,23 +4,28 @@
 #include "types.h"
 #include "structs.h"
 
+extern scratch_blockT *scratch_arena;
 
-int asprintf_s(char **strp, const char *fmt, const char *s0);
-int asprintf_ss(char **strp, const char *fmt, const char *s0, const char *s1);
-int asprintf_sss(char **strp, const char *fmt, const char *s0, const char *s1, const char *s2);
-int asprintf_ssss(char **strp, const char *fmt, const char *s0, const char *s1, const char *s2, const char *s3);
-int asprintf_d(char **strp, const char *fmt, int d0);
+void formatting_failed(void);
+int format_buf(char *buf, size_t size, const char *fmt, ...);
+char *format_alloc(const char *fmt, ...);
+char *scratch_alloc(size_t size);
+char *format_scratch(const char *fmt, ...);
+scratch_markT scratch_mark(void);
+void scratch_release(scratch_markT mark);
+
+int text_width(const char *str, size_t len);
+int string_width(const char *str);
 
 void init_multiline(multiline_textT *multiline);
 void clear_multiline(multiline_textT *multiline);
 void clear_freeable_multiline(freeable_multiline_textT *freeable_multiline);
 void multiline_addline(multiline_textT *multiline, const char *line);
-void multiline_addline_with_len(multiline_textT *multiline, const char *line, int len);
-void print_centered_lr_boxed_string(const char *str, int str_len, const char *l_border, const char *r_border, int width);
-char *center_boxed_string(const char *str, int str_len, const char *border, int width);
+void print_centered_lr_boxed_string(const char *str, const char *l_border, const char *r_border, int width);
+char *center_boxed_string(const char *str, const char *border, int width);
+char *center_boxed_span(const char *text, text_spanT span, const char *border, int width);
 void print_centered_boxed_multiline(multiline_textT *multiline, const char *border, int width);
 
 void wrap_text(wrapped_textT *wrapped, const char *text, size_t max_width);
-void clear_wrapped(wrapped_textT *wrapped);
 
 #endif // FORMAT_H
\ No newline at end of file
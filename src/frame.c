@@ -0,0 +1,167 @@
+#define _POSIX_C_SOURCE 200809L // fileno
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "frame.h"
+#include "format.h"
+#include "utils.h"
+#include "tui.h"
+
+frameT frame = { 0 }; // screen being composed, written to stdout at once by frame_end
+
+/**
+ * @brief writes bytes to stdout with a single write (more only if the terminal takes them partially).
+ * stdio's buffer is flushed first, so they keep their place after anything printed before them.
+ * 
+ * @param buf bytes to write
+ * @param size number of bytes
+ */
+void write_stdout(const char *buf, size_t size) {
+	size_t written = 0;
+	long long n;
+
+	fflush(stdout);
+	while (written < size) {
+#ifdef _WIN32
+		n = _write(_fileno(stdout), buf + written, (unsigned int)(size - written));
+#else
+		n = write(fileno(stdout), buf + written, size - written);
+#endif
+		if (n <= 0) // terminal gone, like puts the output is just lost
+			break;
+		written += (size_t)n;
+	}
+}
+
+/**
+ * @brief writes the composed output to stdout at once
+ * 
+ */
+void frame_flush(void) {
+	write_stdout(frame.buf, frame.used);
+	frame.used = 0;
+}
+
+/**
+ * @brief makes room for the given number of bytes in the frame buffer, doubling its capacity
+ * 
+ * @param size bytes to append
+ */
+void frame_reserve(size_t size) {
+	if (frame.used + size <= frame.capacity)
+		return;
+	if (frame.capacity == 0)
+		frame.capacity = FRAME_MIN_CAPACITY;
+	while (frame.used + size > frame.capacity)
+		frame.capacity *= 2;
+	frame.buf = (char*)realloc_checked(frame.buf, frame.capacity);
+}
+
+/**
+ * @brief starts composing a screen: output appended until the matching frame_end is written at once.
+ * frames nest, only the outermost one is written.
+ * 
+ */
+void frame_begin(void) {
+	frame.depth++;
+}
+
+/**
+ * @brief marks the frame being composed as showing cards (card groups, round banner): in TUI mode it replaces the
+ * screen drawn at the top of the terminal, while other frames (menus, messages) scroll below it
+ * 
+ */
+void frame_screen(void) {
+	frame.screen = true;
+}
+
+/**
+ * @brief ends a screen started by frame_begin, writing it if it's the outermost one (in TUI mode frames marked by
+ * frame_screen are drawn at the top of the terminal instead, see draw_tui_screen)
+ * 
+ */
+void frame_end(void) {
+	frame.depth--;
+	if (frame.depth == 0 && frame.screen && tui.active) {
+		draw_tui_screen(frame.buf, frame.used);
+		frame.used = 0;
+	} else if (frame.depth == 0)
+		frame_flush();
+	if (frame.depth == 0)
+		frame.screen = false;
+}
+
+/**
+ * @brief appends bytes to the screen being composed (written immediately outside of a frame)
+ * 
+ * @param str bytes to append
+ * @param len number of bytes
+ */
+void frame_write(const char *str, size_t len) {
+	frame_reserve(len);
+	memcpy(frame.buf + frame.used, str, len);
+	frame.used += len;
+	if (frame.depth == 0)
+		frame_flush();
+}
+
+/**
+ * @brief appends a string followed by a newline to the screen being composed, like puts
+ * 
+ * @param str string to append
+ */
+void frame_puts(const char *str) {
+	size_t len = strlen(str);
+	frame_reserve(len+1);
+	memcpy(frame.buf + frame.used, str, len);
+	frame.buf[frame.used + len] = '\n';
+	frame.used += len+1;
+	if (frame.depth == 0)
+		frame_flush();
+}
+
+/**
+ * @brief appends the given number of spaces to the screen being composed
+ * 
+ * @param n number of spaces
+ */
+void frame_pad(int n) {
+	if (n <= 0)
+		return;
+	frame_reserve(n);
+	memset(frame.buf + frame.used, ' ', n);
+	frame.used += n;
+	if (frame.depth == 0)
+		frame_flush();
+}
+
+/**
+ * @brief appends a formatted string to the screen being composed, like printf
+ * 
+ * @param fmt format string
+ * @param ... format arguments
+ */
+void frame_printf(const char *fmt, ...) {
+	va_list args;
+	int length;
+
+	va_start(args, fmt);
+	length = vsnprintf(NULL, 0, fmt, args);
+	va_end(args);
+	if (length < 0)
+		formatting_failed();
+
+	frame_reserve(length+1); // vsnprintf always writes the terminator
+	va_start(args, fmt);
+	vsnprintf(frame.buf + frame.used, length+1, fmt, args);
+	va_end(args);
+	frame.used += length;
+	if (frame.depth == 0)
+		frame_flush();
+}
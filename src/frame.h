@@ -0,0 +1,20 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stddef.h>
+#include "types.h"
+#include "structs.h"
+
+extern frameT frame;
+
+void write_stdout(const char *buf, size_t size);
+void frame_flush(void);
+void frame_begin(void);
+void frame_screen(void);
+void frame_end(void);
+void frame_write(const char *str, size_t len);
+void frame_puts(const char *str);
+void frame_pad(int n);
+void frame_printf(const char *fmt, ...);
+
+#endif // FRAME_H
\ No newline at end of file
@@ -6,7 +6,12 @@
 #include "files.h"
 #include "logging.h"
 #include "utils.h"
+#include "input.h"
 #include "saves.h"
+#include "checkpoint.h"
+#include "deck.h"
+#include "graphics.h"
+#include "replay.h"
 
 /**
  * @brief distributes cards at the start of the game to each player as described by the game rules
@@ -41,7 +46,7 @@ giocatoreT *new_player(game_contextT *game_ctx) {
 
 	do {
 		printf("Inserisci il nome del giocatore: ");
-		if (scanf(" %" TO_STRING(GIOCATORE_NAME_LEN) "[^\n]", player->name) == ONE_ELEMENT) {
+		if (get_text(" %" TO_STRING(GIOCATORE_NAME_LEN) "[^\n]", player->name, sizeof(player->name))) {
 			// check name differs from name of every other player inserted
 			distinct = true;
 			for (giocatoreT *other = game_ctx->curr_player; other != NULL && distinct; other = other->next) {
@@ -55,25 +60,67 @@ giocatoreT *new_player(game_contextT *game_ctx) {
 }
 
 /**
- * @brief create a new game context adding players, loading mazzo, initializing different decks and distributing cards
+ * @brief creates the cards of a new game from the chosen base deck and expansion packs
  * 
+ * @param options command-line options: custom base deck (NULL to use the default deck) and expansion packs
+ * @param n_cards out parameter containing number of created cards
+ * @param deck_hash out parameter containing the hash of the merged deck table, identifying the deck of the game
+ * @return cartaT* head of the mazzo cards linked list
+ */
+cartaT *new_mazzo(const launch_optionsT *options, int *n_cards, unsigned int *deck_hash) {
+	deck_tableT deck;
+	cartaT *mazzo;
+
+	init_deck_table(&deck);
+#ifdef EMBEDDED_MAZZO
+	// the default deck is compiled into the executable: no file to read nor parse
+	if (options->deck_path == NULL)
+		deck_merge_pack(&deck, &EMBEDDED_DECK, FILE_MAZZO);
+	else
+		load_mazzo_pack(&deck, options->deck_path);
+#else
+	load_mazzo_pack(&deck, options->deck_path != NULL ? options->deck_path : FILE_MAZZO);
+#endif
+	for (int i = 0; i < options->n_expansions; i++)
+		load_mazzo_pack(&deck, options->expansion_paths[i]);
+
+	mazzo = instantiate_deck(&deck, n_cards);
+	*deck_hash = hash_deck_table(&deck);
+	render_deck(&deck);
+	clear_deck_table(&deck);
+
+	return mazzo;
+}
+
+/**
+ * @brief create a new game context adding players, loading mazzo, initializing different decks and distributing cards.
+ * the decisions of the game are recorded into a replay file next to its save (see replay.c).
+ * 
+ * @param options command-line options: custom base deck and expansion packs
  * @return game_contextT* newly created game context
  */
-game_contextT *new_game(void) {
+game_contextT *new_game(const launch_optionsT *options) {
 	cartaT *mazzo;
 	int n_cards;
+	unsigned int deck_hash;
 	char *save_name;
 	giocatoreT *curr_player = NULL;
 	game_contextT *game_ctx = (game_contextT*)calloc_checked(ONE_ELEMENT, sizeof(game_contextT));
 
-	init_logging(game_ctx);
-	log_msg(game_ctx, "Creazione nuova partita...");
+	init_logging(game_ctx, options);
+	LOG_VALUE(game_ctx, LOG_LEVEL_SESSION, LOG_CAT_SESSION, LOG_EV_NEW_GAME, NULL, 0);
+	init_replay(game_ctx); // from here on every decision is recorded (or replayed)
+	// cards are loaded before the replay file is written, as its header identifies the deck
+	mazzo = new_mazzo(options, &n_cards, &deck_hash);
+	replay_deck(game_ctx, deck_hash);
 
 	save_name = ask_save_name(true);
 	game_ctx->save_path = get_save_path(save_name);
+	open_replay_file(game_ctx, save_name);
 	free_wrap(save_name);
 
-	cache_save_name(game_ctx->save_path);
+	if (!is_replaying(game_ctx))
+		register_save(game_ctx->save_path);
 
 	do {
 		puts("Quanti giocatori giocheranno?");
@@ -89,10 +136,9 @@ game_contextT *new_game(void) {
 			curr_player = curr_player->next = new_player(game_ctx);
 	}
 	curr_player->next = game_ctx->curr_player; // make the linked list circular linking tail to head
+	log_players(game_ctx);
 
-	// load cards
-	mazzo = load_mazzo(&n_cards);
-	fprintf(game_ctx->log_file, "Caricate %d carte nel mazzo!\n", n_cards);
+	LOG_VALUE(game_ctx, LOG_LEVEL_SESSION, LOG_CAT_SESSION, LOG_EV_DECK_LOADED, NULL, n_cards);
 
 	mazzo = shuffle_cards(mazzo);
 
@@ -147,8 +193,13 @@ void clear_stats(player_statsT *head, player_statsT *stats) {
  * @param game_ctx current game state
  */
 void clear_game(game_contextT *game_ctx) {
+	LOG_VALUE(game_ctx, LOG_LEVEL_SESSION, LOG_CAT_SESSION, LOG_EV_CLOSE, NULL, 0);
+	shutdown_logging(game_ctx);
+	close_replay(game_ctx); // before clearing cards, the final state is hashed
+
 	clear_players(game_ctx->curr_player, game_ctx->curr_player);
 	clear_stats(game_ctx->curr_stats, game_ctx->curr_stats);
+	clear_checkpoints(game_ctx);
 
 	if (game_ctx->aula_studio != NULL)
 		clear_cards(game_ctx->aula_studio);
@@ -157,9 +208,7 @@ void clear_game(game_contextT *game_ctx) {
 	if (game_ctx->mazzo_scarti != NULL)
 		clear_cards(game_ctx->mazzo_scarti);
 
-	log_msg(game_ctx, "Chiusura del gioco...");
-
-	shutdown_logging(game_ctx);
+	clear_card_renders();
 	free_wrap(game_ctx->save_path);
 	free_wrap(game_ctx);
 }
\ No newline at end of file
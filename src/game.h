@@ -3,7 +3,7 @@
 
 #include "types.h"
 
-game_contextT *new_game(void);
+game_contextT *new_game(const launch_optionsT *options);
 void clear_game(game_contextT *game_ctx);
 
 #endif // GAME_H
\ No newline at end of file
@@ -8,8 +8,13 @@
 #include "files.h"
 #include "logging.h"
 #include "utils.h"
+#include "input.h"
 #include "effects.h"
 #include "stats.h"
+#include "checkpoint.h"
+#include "replay.h"
+#include "frame.h"
+#include "tui.h"
 
 /**
  * @brief checks if the provided target is current round's player
@@ -135,23 +140,21 @@ bool player_can_defend(giocatoreT *target, cartaT *attack_card) {
  * @return false if the attack wasn't blocked by target
  */
 bool target_defends(game_contextT *game_ctx, giocatoreT *target, cartaT *attack_card, effettoT *attack_effect) {
-	char *prompt, *effect_description, *attack_description, *fmt_attack_description;
+	char prompt[FORMAT_LINE_LEN], effect_description[FORMAT_LINE_LEN], fmt_attack_description[FORMAT_LINE_LEN];
 	cartaT *defense_card;
 	bool valid_defense = false, defends = false;
 	giocatoreT *attacker = game_ctx->curr_player;
 
 	if (attack_effect == CARD_PLACEMENT) {
-		asprintf_ss(&attack_description, "dal piazzamento di '%s' nei %s", attack_card->name, tipo_cartaT_str(attack_card->tipo));
-		asprintf_sss(&fmt_attack_description, "dal piazzamento di '%s' nei " COLORED_CARD_TYPE,
+		format_buf(fmt_attack_description, sizeof(fmt_attack_description), "dal piazzamento di '%s' nei " COLORED_CARD_TYPE,
 			attack_card->name,
 			tipo_cartaT_color(attack_card->tipo),
 			tipo_cartaT_str(attack_card->tipo)
 		);
 	}
 	else {
-		format_effect(&effect_description, attack_effect);
-		asprintf_ss(&attack_description, "dall'attacco %s di '%s'", effect_description, attack_card->name);
-		asprintf_ss(&fmt_attack_description, "dall'attacco " ANSI_BOLD "%s" ANSI_RESET " di '%s'", effect_description, attack_card->name);
+		format_effect(effect_description, sizeof(effect_description), attack_effect);
+		format_buf(fmt_attack_description, sizeof(fmt_attack_description), "dall'attacco " ANSI_BOLD "%s" ANSI_RESET " di '%s'", effect_description, attack_card->name);
 	}
 
 	if (player_can_defend(target, attack_card)) { // first check if target player can actually defend from the attack
@@ -164,7 +167,7 @@ bool target_defends(game_contextT *game_ctx, giocatoreT *target, cartaT *attack_
 	}
 
 	if (defends) { // user can and wants to defend from the attack
-		asprintf_ssss(&prompt, "[%s] Scegli con quale carta " COLORED_CARD_TYPE " difenderti dall'attacco di " PRETTY_USERNAME ".",
+		format_buf(prompt, sizeof(prompt), "[%s] Scegli con quale carta " COLORED_CARD_TYPE " difenderti dall'attacco di " PRETTY_USERNAME ".",
 			target->name,
 			tipo_cartaT_color(ISTANTANEA),
 			tipo_cartaT_str(ISTANTANEA),
@@ -176,14 +179,16 @@ bool target_defends(game_contextT *game_ctx, giocatoreT *target, cartaT *attack_
 			if (card_can_block(target, defense_card, attack_card)) // verify picked defense card can defend from the attack card
 				valid_defense = true;
 		} while (!valid_defense);
-		free_wrap(prompt);
 
 		printf(PRETTY_USERNAME " si difende %s da parte di " PRETTY_USERNAME " usando '%s'!\n",
 			target->name, fmt_attack_description, attacker->name, defense_card->name
 		);
-		log_ssss(game_ctx, "%s si difende %s da parte di %s usando '%s'.",
-			target->name, attack_description, attacker->name, defense_card->name
-		);
+		if (attack_effect == CARD_PLACEMENT)
+			LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_DEFENSE, LOG_EV_DEFEND_PLACEMENT,
+				attacker, target, attack_card, defense_card, attack_card->tipo, NULL);
+		else
+			LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_DEFENSE, LOG_EV_DEFEND_EFFECT,
+				attacker, target, attack_card, defense_card, attack_effect->target_carta, attack_effect);
 
 		unlink_card(&target->carte, defense_card); // remove chosen defense card from target's hand
 	
@@ -195,10 +200,6 @@ bool target_defends(game_contextT *game_ctx, giocatoreT *target, cartaT *attack_
 		dispose_card(game_ctx, defense_card); // dispose chosen defense card after its use ended
 	}
 
-	if (attack_effect != CARD_PLACEMENT)
-		free_wrap(effect_description);
-	free_wrap(attack_description);
-	free_wrap(fmt_attack_description);
 
 	return defends;
 }
@@ -209,14 +210,16 @@ bool target_defends(game_contextT *game_ctx, giocatoreT *target, cartaT *attack_
  * @param player target player
  */
 void show_player_state(giocatoreT *player) {
-	printf("Ecco lo stato di " PRETTY_USERNAME ":\n", player->name);
+	frame_begin(); // the whole state is written at once
+	frame_printf("Ecco lo stato di " PRETTY_USERNAME ":\n", player->name);
 
 	if (has_bonusmalus(player, MOSTRA))
 		show_card_group(player->carte, "Mano:", ANSI_BOLD ANSI_CYAN "%s" ANSI_RESET); // show mano
 	else
-		printf("Numero carte nella mano: %d\n", count_cards(player->carte));
+		frame_printf("Numero carte nella mano: %d\n", count_cards(player->carte));
 	show_card_group(player->aula, "Aula:", ANSI_BOLD ANSI_YELLOW "%s" ANSI_RESET); // show aula
 	show_card_group(player->bonus_malus, "Bonus/Malus:", ANSI_BOLD ANSI_MAGENTA "%s" ANSI_RESET); // show bonus/malus
+	frame_end();
 }
 
 /**
@@ -225,11 +228,13 @@ void show_player_state(giocatoreT *player) {
  * @param game_ctx current game state
  */
 void view_own(game_contextT *game_ctx) {
-	printf("Ecco le carte in tuo possesso, " PRETTY_USERNAME ":\n", game_ctx->curr_player->name);
+	frame_begin(); // the whole screen is written at once
+	frame_printf("Ecco le carte in tuo possesso, " PRETTY_USERNAME ":\n", game_ctx->curr_player->name);
 
 	show_card_group(game_ctx->curr_player->aula, "Aula:", ANSI_BOLD ANSI_YELLOW "%s" ANSI_RESET); // show aula
 	show_card_group(game_ctx->curr_player->bonus_malus, "Bonus/Malus:", ANSI_BOLD ANSI_MAGENTA "%s" ANSI_RESET); // show bonus/malus
 	show_card_group(game_ctx->curr_player->carte, "Mano:", ANSI_BOLD ANSI_CYAN "%s" ANSI_RESET); // show mano
+	frame_end();
 }
 
 /**
@@ -240,9 +245,11 @@ void view_own(game_contextT *game_ctx) {
 void view_others(game_contextT *game_ctx) {
 	giocatoreT *target = pick_player(game_ctx, "Scegli il giocatore del quale vuoi vedere lo stato:", !ALLOW_SELF, ALLOW_ALL);
 	if (target == NULL) { // picked option is ALL
-		// start from next player based on turns
+		// start from next player based on turns, every state in the same screen
+		frame_begin();
 		for (giocatoreT *player = game_ctx->curr_player->next; player != game_ctx->curr_player; player = player->next)
 			show_player_state(player);
+		frame_end();
 	} else
 		show_player_state(target);
 }
@@ -262,12 +269,14 @@ giocatoreT *pick_player(game_contextT *game_ctx, const char *prompt, bool allow_
 		all_idx = tot_players + 1,
 		max_choice = allow_all ? all_idx : tot_players;
 	do {
-		puts(prompt);
+		frame_begin();
+		frame_puts(prompt);
 		player = allow_self ? game_ctx->curr_player : game_ctx->curr_player->next; // start from curr or next player based on turns
 		for (int i = 1; i < all_idx; i++, player = player->next)
-			printf(" [TASTO %d] %s%s\n", i, player->name, player == game_ctx->curr_player ? " (io)" : "");
+			frame_printf(" [TASTO %d] %s%s\n", i, player->name, player == game_ctx->curr_player ? " (io)" : "");
 		if (allow_all)
-			printf(" [TASTO %d] Tutti i giocatori\n", all_idx);
+			frame_printf(" [TASTO %d] Tutti i giocatori\n", all_idx);
+		frame_end();
 		chosen_idx = get_int();
 	} while (chosen_idx < 1 || chosen_idx > max_choice);
 	
@@ -288,7 +297,7 @@ giocatoreT *pick_player(game_contextT *game_ctx, const char *prompt, bool allow_
  * @param head cards list
  * @param type card type user is allowed to pick
  * @param prompt text shown to the user while asked to pick the card
- * @param title title of the group of cards (used to calculate visual length of title), can't contain colors
+ * @param title title of the group of cards
  * @param title_fmt title format string (must always contain one and only one %s and no other formatters), can contain colors
  * @return cartaT* pointer to picked card or NULL if there's no card to pick
  */
@@ -308,12 +317,14 @@ cartaT *pick_card(cartaT *head, tipo_cartaT type, const char *prompt, const char
 	}
 
 	do {
-		puts(prompt);
+		frame_begin();
+		frame_puts(prompt);
 		card = head;
 		for (int idx = 1; idx <= n_cards; card = card->next) {
 			if (match_card_type(card, type))
-				printf(" [TASTO %d] %s\n", idx++, card->name);
+				frame_printf(" [TASTO %d] %s\n", idx++, card->name);
 		}
+		frame_end();
 		chosen_idx = get_int();
 	} while (chosen_idx < 1 || chosen_idx > n_cards);
 	return card_by_index_restricted(head, type, chosen_idx);
@@ -358,7 +369,7 @@ cartaT *pick_random_card(cartaT *head, tipo_cartaT type) {
  */
 cartaT *pick_aula_card(game_contextT *game_ctx, giocatoreT *target, tipo_cartaT type, const char *prompt) {
 	cartaT *card;
-	char *aula_title, *bonusmalus_title;
+	char aula_title[FORMAT_LINE_LEN], bonusmalus_title[FORMAT_LINE_LEN];
 	int chosen_idx, n_aula = count_cards_restricted(target->aula, type), n_bonusmalus = count_cards_restricted(target->bonus_malus, type);
 
 	if (n_aula + n_bonusmalus == 0) {
@@ -379,21 +390,21 @@ cartaT *pick_aula_card(game_contextT *game_ctx, giocatoreT *target, tipo_cartaT
 	// build dynamic titles containing target player name and target card type
 	if (is_self(game_ctx, target)) {
 		if (type == ALL) {
-			aula_title = strdup_checked("La tua aula");
-			bonusmalus_title = strdup_checked("Le tue Bonus/Malus");
+			format_buf(aula_title, sizeof(aula_title), "La tua aula");
+			format_buf(bonusmalus_title, sizeof(bonusmalus_title), "Le tue Bonus/Malus");
 		} else { // pickable cards can only be in aula or bonusmalus lists (not both)
 			// only one of these titles will be used, make them equal. must contain target card type
-			asprintf_s(&aula_title, "Le tue carte %s", tipo_cartaT_str(type));
-			bonusmalus_title = strdup_checked(aula_title);
+			format_buf(aula_title, sizeof(aula_title), "Le tue carte %s", tipo_cartaT_str(type));
+			format_buf(bonusmalus_title, sizeof(bonusmalus_title), "%s", aula_title);
 		}
 	} else {
 		if (type == ALL) {
-			asprintf_s(&aula_title, "Aula di %s", target->name);
-			asprintf_s(&bonusmalus_title, "Bonus/Malus di %s", target->name);
+			format_buf(aula_title, sizeof(aula_title), "Aula di %s", target->name);
+			format_buf(bonusmalus_title, sizeof(bonusmalus_title), "Bonus/Malus di %s", target->name);
 		} else { // pickable cards can only be in aula or bonusmalus lists (not both)
 			// only one of these titles will be used, make them equal. must contain target player name and target card type
-			asprintf_ss(&aula_title, "Carte %s di %s", tipo_cartaT_str(type), target->name);
-			bonusmalus_title = strdup_checked(aula_title);
+			format_buf(aula_title, sizeof(aula_title), "Carte %s di %s", tipo_cartaT_str(type), target->name);
+			format_buf(bonusmalus_title, sizeof(bonusmalus_title), "%s", aula_title);
 		}
 	}
 
@@ -403,8 +414,10 @@ cartaT *pick_aula_card(game_contextT *game_ctx, giocatoreT *target, tipo_cartaT
 		card = pick_card(target->bonus_malus, type, prompt, bonusmalus_title, ANSI_BOLD ANSI_MAGENTA "%s" ANSI_RESET);
 	} else { // both aula and bonus/malus have cards and given type must be ALL
 		do {
+			frame_begin(); // both groups in the same screen
 			show_card_group(target->aula, aula_title, ANSI_BOLD ANSI_YELLOW "%s" ANSI_RESET); // show aula
 			show_card_group(target->bonus_malus, bonusmalus_title, ANSI_BOLD ANSI_MAGENTA "%s" ANSI_RESET); // show bonus/malus
+			frame_end();
 
 			if (is_self(game_ctx, target))
 				printf("[%s] Vuoi scegliere una carta " COLORED_CARD_TYPE " dalla tua aula studenti o dai tuoi Bonus/Malus?\n",
@@ -419,8 +432,7 @@ cartaT *pick_aula_card(game_contextT *game_ctx, giocatoreT *target, tipo_cartaT
 					tipo_cartaT_str(type),
 					target->name
 				);
-			puts(" [TASTO " TO_STRING(CHOICE_AULA) "] Aula");
-			puts(" [TASTO " TO_STRING(CHOICE_BONUSMALUS) "] Bonus/Malus");
+			frame_puts(" [TASTO " TO_STRING(CHOICE_AULA) "] Aula\n [TASTO " TO_STRING(CHOICE_BONUSMALUS) "] Bonus/Malus");
 			chosen_idx = get_int();
 		} while (chosen_idx < CHOICE_AULA || chosen_idx > CHOICE_BONUSMALUS);
 
@@ -429,8 +441,6 @@ cartaT *pick_aula_card(game_contextT *game_ctx, giocatoreT *target, tipo_cartaT
 		else // choice was bonus/malus
 			card = pick_card(target->bonus_malus, type, prompt, bonusmalus_title, ANSI_BOLD ANSI_MAGENTA "%s" ANSI_RESET);
 	}
-	free_wrap(bonusmalus_title);
-	free_wrap(aula_title);
 	return card;
 }
 
@@ -462,12 +472,12 @@ void discard_card(game_contextT *game_ctx, cartaT **cards, tipo_cartaT type, con
 		unlink_card(cards, card);
 		dispose_card(game_ctx, card); // dispose discarded card
 		printf("Hai scartato: %s\n", card->name);
-		log_ss(game_ctx, "%s ha scartato '%s'.", game_ctx->curr_player->name, card->name);
+		LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_CARDS, LOG_EV_DISCARD, game_ctx->curr_player, NULL, card, NULL, card->tipo, NULL);
 		stats_add_discarded(game_ctx);
 	}
 	else {
 		printf("Avresti dovuto scartare una carta " COLORED_CARD_TYPE ", ma non ne hai!\n", tipo_cartaT_color(type), tipo_cartaT_str(type));
-		log_ss(game_ctx, "%s avrebbe dovuto scartare una carta %s, ma non ne aveva.", game_ctx->curr_player->name, tipo_cartaT_str(type));
+		LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_CARDS, LOG_EV_DISCARD_NONE, game_ctx->curr_player, NULL, NULL, NULL, type, NULL);
 	}
 }
 
@@ -490,7 +500,8 @@ cartaT *draw_card(game_contextT *game_ctx) {
 	drawn_card = pop_card(&game_ctx->mazzo_pesca);
 	puts("Ecco la carta che hai pescato:");
 	show_card(drawn_card);
-	log_ss(game_ctx, "%s ha pescato '%s'.", game_ctx->curr_player->name, drawn_card->name);
+	LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_CARDS, LOG_EV_DRAW,
+		game_ctx->curr_player, NULL, drawn_card, NULL, drawn_card->tipo, NULL);
 	push_card(&game_ctx->curr_player->carte, drawn_card);
 	return drawn_card;
 }
@@ -526,7 +537,7 @@ bool play_card(game_contextT *game_ctx, tipo_cartaT type) {
 	bool played = false;
 	cartaT *card;
 	giocatoreT *target, *thrower;
-	char *playable_prompt, *player_prompt;
+	char playable_prompt[FORMAT_LINE_LEN], player_prompt[FORMAT_LINE_LEN];
 
 	target = thrower = game_ctx->curr_player;
 
@@ -536,17 +547,17 @@ bool play_card(game_contextT *game_ctx, tipo_cartaT type) {
 			tipo_cartaT_color(type),
 			tipo_cartaT_str(type)
 		);
-		log_ss(game_ctx, "%s avrebbe dovuto giocare una carta %s ma non ne aveva di giocabili.", thrower->name, tipo_cartaT_str(type));
+		LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_CARDS, LOG_EV_NO_PLAYABLE, thrower, NULL, NULL, NULL, type, NULL);
 		return false;
 	}
 
 	if (type != ALL)
-		asprintf_ss(&playable_prompt, "Scegli la carta " COLORED_CARD_TYPE " che vuoi giocare.",
+		format_buf(playable_prompt, sizeof(playable_prompt), "Scegli la carta " COLORED_CARD_TYPE " che vuoi giocare.",
 			tipo_cartaT_color(type),
 			tipo_cartaT_str(type)
 		);
 	else
-		playable_prompt = strdup_checked("Scegli la carta che vuoi giocare.");
+		format_buf(playable_prompt, sizeof(playable_prompt), "Scegli la carta che vuoi giocare.");
 
 	card = pick_card(thrower->carte, type, playable_prompt, "La tua mano", ANSI_BOLD ANSI_CYAN "%s" ANSI_RESET);
 	// no need to check for not-NULL card returned as there are selectable cards according to count_playable_cards
@@ -559,12 +570,8 @@ bool play_card(game_contextT *game_ctx, tipo_cartaT type) {
 			tipo_cartaT_color(card->tipo),
 			tipo_cartaT_str(card->tipo)
 		);
-		log_ssss(game_ctx, "%s ha provato a giocare '%s' ma ha l'effetto %s attivo su carte %s.",
-			thrower->name,
-			card->name,
-			azioneT_str(IMPEDIRE),
-			tipo_cartaT_str(card->tipo)
-		);
+		LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_CARDS, LOG_EV_PLAY_PREVENTED,
+			thrower, NULL, card, NULL, card->tipo, &(effettoT){ IMPEDIRE, IO, ALL });
 	} else {
 		switch (card->tipo) {
 			case ISTANTANEA: {
@@ -581,16 +588,15 @@ bool play_card(game_contextT *game_ctx, tipo_cartaT type) {
 			case LAUREANDO: {
 				// BONUS and MALUS can be placed both in own and other player's bonusmalus
 				if (match_card_type(card, BONUS) || match_card_type(card, MALUS)) {
-					asprintf_sss(&player_prompt, "Scegli un giocatore al quale piazzare '%s' nei " COLORED_CARD_TYPE ".",
+					format_buf(player_prompt, sizeof(player_prompt), "Scegli un giocatore al quale piazzare '%s' nei " COLORED_CARD_TYPE ".",
 						card->name,
 						tipo_cartaT_color(card->tipo),
 						tipo_cartaT_str(card->tipo)
 					);
 					target = pick_player(game_ctx, player_prompt, ALLOW_SELF, !ALLOW_ALL);
-					free_wrap(player_prompt);
 				}
 				if (can_join_aula(target, card)) {
-					log_sss(game_ctx, "%s gioca '%s' su %s.", thrower->name, card->name, target->name);
+					LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_CARDS, LOG_EV_PLAY_ON, thrower, target, card, NULL, card->tipo, NULL);
 					unlink_card(&thrower->carte, card);
 					if (target == thrower || !target_defends(game_ctx, target, card, CARD_PLACEMENT)) // can't defended from self thrown cards
 						join_aula(game_ctx, target, card);
@@ -611,7 +617,8 @@ bool play_card(game_contextT *game_ctx, tipo_cartaT type) {
 						unlink_card(&thrower->carte, card);
 						dispose_card(game_ctx, card);
 						puts("Carta scartata!");
-						log_sss(game_ctx, "%s ha provato a giocare '%s' su %s (duplicato), scartandola.", thrower->name, card->name, target->name);
+						LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_CARDS, LOG_EV_PLAY_DUPLICATE,
+							thrower, target, card, NULL, card->tipo, NULL);
 						stats_add_played_card(game_ctx, card);
 						played = true;
 					}
@@ -620,7 +627,7 @@ bool play_card(game_contextT *game_ctx, tipo_cartaT type) {
 			}
 			case MAGIA: {
 				// always quando = SUBITO, no additional checks needed
-				log_ss(game_ctx, "%s gioca '%s'.", thrower->name, card->name);
+				LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_CARDS, LOG_EV_PLAY, thrower, NULL, card, NULL, card->tipo, NULL);
 				unlink_card(&thrower->carte, card);
 				apply_effects(game_ctx, card, SUBITO);
 				dispose_card(game_ctx, card);
@@ -635,7 +642,6 @@ bool play_card(game_contextT *game_ctx, tipo_cartaT type) {
 		}
 	}
 
-	free_wrap(playable_prompt);
 
 	return played ? true : play_card(game_ctx, type); // recurse if player didnt play anything (but actually could)
 }
@@ -648,17 +654,45 @@ bool play_card(game_contextT *game_ctx, tipo_cartaT type) {
 int choice_action_menu(void) {
 	int action;
 	do {
-		puts("Che azione vuoi eseguire?");
-		puts(" [TASTO " TO_STRING(ACTION_PLAY_HAND) "] Gioca una carta dalla tua mano");
-		puts(" [TASTO " TO_STRING(ACTION_DRAW) "] Pesca un'altra carta");
-		puts(" [TASTO " TO_STRING(ACTION_VIEW_OWN) "] Visualizza le tue carte");
-		puts(" [TASTO " TO_STRING(ACTION_VIEW_OTHERS) "] Visualizza lo stato degli altri giocatori");
-		puts(" [TASTO " TO_STRING(ACTION_QUIT) "] Esci dalla partita");
+		// a single string, written at once
+		frame_puts("Che azione vuoi eseguire?\n"
+			" [TASTO " TO_STRING(ACTION_PLAY_HAND) "] Gioca una carta dalla tua mano\n"
+			" [TASTO " TO_STRING(ACTION_DRAW) "] Pesca un'altra carta\n"
+			" [TASTO " TO_STRING(ACTION_VIEW_OWN) "] Visualizza le tue carte\n"
+			" [TASTO " TO_STRING(ACTION_VIEW_OTHERS) "] Visualizza lo stato degli altri giocatori\n"
+			" [TASTO " TO_STRING(ACTION_ROLLBACK) "] Torna all'inizio di un round precedente\n"
+			" [TASTO " TO_STRING(ACTION_TOGGLE_VIEW) "] Alterna la vista compatta e dettagliata delle carte\n"
+			" [TASTO " TO_STRING(ACTION_QUIT) "] Esci dalla partita");
 		action = get_int();
-	} while (action < ACTION_QUIT || action > ACTION_VIEW_OTHERS);
+	} while (action < ACTION_QUIT || action > ACTION_TOGGLE_VIEW);
 	return action;
 }
 
+/**
+ * @brief prompts user to roll the game back to the start of the current or of a previous round, using in-memory checkpoints
+ * 
+ * @param game_ctx current game state
+ * @return true if the game was rolled back
+ * @return false if user cancelled the rollback
+ */
+bool rollback_rounds(game_contextT *game_ctx) {
+	int rounds_back, max_rounds_back = available_rollbacks(game_ctx);
+	bool rolled_back = false;
+
+	do {
+		printf("Di quanti round vuoi tornare indietro? (0 per ricominciare il round attuale, massimo %d, -1 per annullare)\n", max_rounds_back);
+		rounds_back = get_int();
+	} while (rounds_back < -1 || rounds_back > max_rounds_back);
+
+	if (rounds_back != -1) {
+		restore_checkpoint(game_ctx, rounds_back);
+		printf("Partita riportata all'inizio del round %d!\n", game_ctx->round_num);
+		LOG_EVENT(game_ctx, LOG_LEVEL_ROUND, LOG_CAT_ROUND, LOG_EV_ROLLBACK, game_ctx->curr_player, NULL, NULL, NULL, ALL, NULL);
+		rolled_back = true;
+	}
+	return rolled_back;
+}
+
 /**
  * @brief applies leave effects of card and removes it from player's aula
  * 
@@ -675,7 +709,7 @@ void leave_aula(game_contextT *game_ctx, giocatoreT *player, cartaT *card, bool
 	else
 		unlink_card(&player->bonus_malus, card); // is BONUS/MALUS
 
-	log_sss(game_ctx, "Una carta %s lascia l'aula di %s: '%s'.", tipo_cartaT_str(card->tipo), player->name, card->name);
+	LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_CARDS, LOG_EV_LEAVE_AULA, game_ctx->curr_player, player, card, NULL, card->tipo, NULL);
 	if (dispatch_effects) {
 		// switch current player to card owner player for applying FINE effects correctly
 		original_player = game_ctx->curr_player;
@@ -720,7 +754,7 @@ void join_aula(game_contextT *game_ctx, giocatoreT *player, cartaT *card) {
 		push_card(&player->aula, card);
 	else // is BONUS/MALUS
 		push_card(&player->bonus_malus, card);
-	log_sss(game_ctx, "Una carta %s entra nell'aula di %s: '%s'.", tipo_cartaT_str(card->tipo), player->name, card->name);
+	LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_CARDS, LOG_EV_JOIN_AULA, game_ctx->curr_player, player, card, NULL, card->tipo, NULL);
 	apply_effects(game_ctx, card, SUBITO); // apply join effects
 }
 
@@ -743,7 +777,9 @@ bool check_win_condition(game_contextT *game_ctx) {
  * @param game_ctx current game state
  */
 void begin_round(game_contextT *game_ctx) {
-	save_game(game_ctx);
+	capture_checkpoint(game_ctx);
+	if (!is_replaying(game_ctx))
+		save_game(game_ctx);
 
 	show_round(game_ctx);
 
@@ -780,6 +816,18 @@ void play_round(game_contextT *game_ctx) {
 				view_others(game_ctx);
 				break;
 			}
+			case ACTION_ROLLBACK: {
+				if (rollback_rounds(game_ctx)) {
+					game_ctx->rolled_back = true;
+					in_action = false; // end action phase, restored round starts over
+				}
+				break;
+			}
+			case ACTION_TOGGLE_VIEW: {
+				compact_view = !compact_view;
+				puts(compact_view ? "Vista compatta: le carte vengono elencate una per riga." : "Vista dettagliata: le carte vengono mostrate per intero.");
+				break;
+			}
 			case ACTION_QUIT: {
 				printf("Sei sicuro di volere uscire da questa partita? ");
 				if (ask_choice()) {
@@ -801,6 +849,11 @@ void end_round(game_contextT *game_ctx) {
 	if (!game_ctx->game_running)
 		return;
 
+	if (game_ctx->rolled_back) { // game state was restored to the start of a round, don't end it
+		game_ctx->rolled_back = false;
+		return;
+	}
+
 	// hand max cards check
 	while (count_cards(game_ctx->curr_player->carte) > ENDROUND_MAX_CARDS) {
 		puts("Puoi avere massimo " ANSI_BOLD TO_STRING(ENDROUND_MAX_CARDS) ANSI_RESET " carte in mano alla fine del round!");
@@ -810,14 +863,35 @@ void end_round(game_contextT *game_ctx) {
 	stats_add_round(game_ctx);
 
 	if (check_win_condition(game_ctx)) { // check if curr player won
+		stop_tui(); // the alternate screen goes away at exit, the winner is shown on the normal one
 		printf(ANSI_CYAN "\nCongratulazioni " ANSI_RED ANSI_BOLD PRETTY_USERNAME ANSI_CYAN ", hai vinto la partita!\n\n" ANSI_RESET, game_ctx->curr_player->name);
 		puts(WIN_ASCII_ART);
-		log_s(game_ctx, "%s ha vinto la partita!", game_ctx->curr_player->name);
+		LOG_EVENT(game_ctx, LOG_LEVEL_ROUND, LOG_CAT_ROUND, LOG_EV_WIN, game_ctx->curr_player, NULL, NULL, NULL, ALL, NULL);
 		stats_add_win(game_ctx);
+		end_game_record(game_ctx);
+		if (!is_replaying(game_ctx))
+			save_game_winner(game_ctx);
 		game_ctx->game_running = false; // stop game
 	} else { // no win, keep playing
 		printf("\nRound di " PRETTY_USERNAME " completato!\n", game_ctx->curr_player->name);
+		LOG_VALUE(game_ctx, LOG_LEVEL_ROUND, LOG_CAT_ROUND, LOG_EV_ROUND_END, game_ctx->curr_player, count_cards(game_ctx->curr_player->carte));
 		switch_player(game_ctx, game_ctx->curr_player->next); // next round its next player's turn
 		game_ctx->round_num++;
 	}
 }
+
+/**
+ * @brief plays rounds until the game is won or quit
+ * 
+ * @param game_ctx current game state
+ */
+void play_game(game_contextT *game_ctx) {
+	game_ctx->game_running = true;
+	while (game_ctx->game_running) {
+		begin_round(game_ctx);
+
+		play_round(game_ctx);
+
+		end_round(game_ctx);
+	}
+}
@@ -31,5 +31,6 @@ void leave_aula(game_contextT *game_ctx, giocatoreT *player, cartaT *card, bool
 void begin_round(game_contextT *game_ctx);
 void play_round(game_contextT *game_ctx);
 void end_round(game_contextT *game_ctx);
+void play_game(game_contextT *game_ctx);
 
 #endif // GAMEPLAY_H
\ No newline at end of file
@@ -8,15 +8,22 @@
 #include "utils.h"
 #include "string.h"
 #include "card.h"
+#include "frame.h"
+#include "tui.h"
+
+card_render_cacheT card_renders = { 0 }; // rendered card boxes by card name, built at first display
+bool compact_view = false; // card groups list a line per card instead of their boxes
 
 /**
- * @brief formats an effect into an heap allocated string
+ * @brief formats an effect into a buffer
  * 
- * @param str pointer to formatted string
+ * @param buf buffer receiving the formatted effect
+ * @param size size of the buffer
  * @param effect pointer to effect to be formatted
+ * @return int length of the formatted effect
  */
-void format_effect(char **str, effettoT *effect) {
-	asprintf_sss(str, "%s -> %s (%s)",
+int format_effect(char *buf, size_t size, effettoT *effect) {
+	return format_buf(buf, size, "%s -> %s (%s)",
 		azioneT_str(effect->azione),
 		tipo_cartaT_str(effect->target_carta),
 		target_giocatoriT_str(effect->target_giocatori)
@@ -24,60 +31,55 @@ void format_effect(char **str, effettoT *effect) {
 }
 
 /**
- * @brief formats a card's effects into a freeable multiline
+ * @brief formats a card's effects into a multiline, lines are formatted in the scratch arena
  * 
  * @param multiline pointer to the multiline
  * @param card pointer to the card
  */
-void format_effects(freeable_multiline_textT *multiline, cartaT *card) {
-	char *line;
+void format_effects(multiline_textT *multiline, cartaT *card) {
+	char line[FORMAT_LINE_LEN];
 	if (card->n_effetti != 0) {
 		// add upper padding
 		for (int i = 0; i < MAX_EFFECTS-card->n_effetti; i++)
-			multiline_addline(multiline, strdup_checked(""));
+			multiline_addline(multiline, "");
 
 		// add effects header
-		asprintf_s(&line, "Opzionale: %s", card->opzionale ? "Si" : "No");
-		multiline_addline(multiline, line);
-		asprintf_s(&line, "Quando: %s", quandoT_str(card->quando));
-		multiline_addline(multiline, line);
-		asprintf_d(&line, "Effetti (%d):", card->n_effetti);
-		multiline_addline(multiline, line);
+		multiline_addline(multiline, format_scratch("Opzionale: %s", card->opzionale ? "Si" : "No"));
+		multiline_addline(multiline, format_scratch("Quando: %s", quandoT_str(card->quando)));
+		multiline_addline(multiline, format_scratch("Effetti (%d):", card->n_effetti));
 
 		// add actual effects
 		for (int i = 0; i < card->n_effetti; i++) {
-			format_effect(&line, &card->effetti[i]);
-			multiline_addline(multiline, line);
+			format_effect(line, sizeof(line), &card->effetti[i]);
+			multiline_addline(multiline, format_scratch("%s", line));
 		}
 	} else {
 		// add padding
 		for (int i = 1; i < CARD_EFFECTS_HEIGHT; i++) // skip 1 row reserved to "Nessun effetto!"
-			multiline_addline(multiline, strdup_checked(""));
-		multiline_addline(multiline, strdup_checked("Nessun effetto!"));
+			multiline_addline(multiline, "");
+		multiline_addline(multiline, "Nessun effetto!");
 	}
 }
 
 /**
- * @brief formats a card into a box inside a freeable multiline
+ * @brief formats a card into a box inside a multiline, lines are formatted in the scratch arena (the caller releases
+ * them once printed)
  * 
  * @param multiline pointer to the multiline
  * @param card pointer to the card
  */
-void build_card(freeable_multiline_textT *multiline, cartaT *card) {
-	char *h_border, *v_border, *fmt_name, *type, *fmt_type;
-	int len_name, len_type;
+void build_card(multiline_textT *multiline, cartaT *card) {
+	char *h_border, *v_border, *fmt_name, *fmt_type;
 	wrapped_textT wrapped_description;
-	freeable_multiline_textT effects_lines;
+	multiline_textT effects_lines;
 	init_multiline(&effects_lines);
 
-	asprintf_s(&h_border, "%s" CARD_CORNER_LEFT HORIZONTAL_BAR CARD_CORNER_RIGHT ANSI_RESET, tipo_cartaT_color(card->tipo));
-	asprintf_s(&v_border, "%s" CARD_BORDER_VERTICAL ANSI_RESET, tipo_cartaT_color(card->tipo));
+	h_border = format_scratch("%s" CARD_CORNER_LEFT HORIZONTAL_BAR CARD_CORNER_RIGHT ANSI_RESET, tipo_cartaT_color(card->tipo));
+	v_border = format_scratch("%s" CARD_BORDER_VERTICAL ANSI_RESET, tipo_cartaT_color(card->tipo));
 
-	len_name = strlen(card->name);
-	asprintf_s(&fmt_name, ANSI_BOLD "%s" ANSI_RESET, card->name);
+	fmt_name = format_scratch(ANSI_BOLD "%s" ANSI_RESET, card->name);
 
-	len_type = asprintf_s(&type, "#%s", tipo_cartaT_str(card->tipo));
-	asprintf_ss(&fmt_type, ANSI_BOLD "%s%s" ANSI_RESET, tipo_cartaT_color(card->tipo), type);
+	fmt_type = format_scratch(ANSI_BOLD "%s#%s" ANSI_RESET, tipo_cartaT_color(card->tipo), tipo_cartaT_str(card->tipo));
 
 	// compute wrapped description
 	wrap_text(&wrapped_description, card->description, CARD_CONTENT_WIDTH-CARD_PADDING);
@@ -87,92 +89,266 @@ void build_card(freeable_multiline_textT *multiline, cartaT *card) {
 
 	// add all lines now
 	// append upper border
-	multiline_addline(multiline, strdup_checked(h_border));
+	multiline_addline(multiline, h_border);
 	// append type
-	multiline_addline(multiline, center_boxed_string(fmt_type, len_type, v_border, CARD_CONTENT_WIDTH));
+	multiline_addline(multiline, center_boxed_string(fmt_type, v_border, CARD_CONTENT_WIDTH));
 	// append name
-	multiline_addline(multiline, center_boxed_string(fmt_name, len_name, v_border, CARD_CONTENT_WIDTH));
+	multiline_addline(multiline, center_boxed_string(fmt_name, v_border, CARD_CONTENT_WIDTH));
 	// now append wrapped description
-	for (int i = 0; i < wrapped_description.multiline.n_lines; i++) {
-		multiline_addline(multiline, center_boxed_string(
-			wrapped_description.multiline.lines[i],
-			wrapped_description.multiline.lengths[i],
-			v_border,
-			CARD_CONTENT_WIDTH
-		)); // add centered boxed line
-	}
+	for (int i = 0; i < wrapped_description.n_lines; i++) // add centered boxed line
+		multiline_addline(multiline, center_boxed_span(card->description, wrapped_description.lines[i], v_border, CARD_CONTENT_WIDTH));
 	// append spacing for reserved description height
-	for (int i = 0; i < CARD_DESCRIPTION_HEIGHT-wrapped_description.multiline.n_lines; i++)
-		multiline_addline(multiline, center_boxed_string("", 0, v_border, CARD_CONTENT_WIDTH));
+	for (int i = 0; i < CARD_DESCRIPTION_HEIGHT-wrapped_description.n_lines; i++)
+		multiline_addline(multiline, center_boxed_string("", v_border, CARD_CONTENT_WIDTH));
 	// now append effects
 	for (int i = 0; i < effects_lines.n_lines; i++) {
 		multiline_addline(multiline, center_boxed_string(
 			effects_lines.lines[i],
-			effects_lines.lengths[i],
 			v_border,
 			CARD_CONTENT_WIDTH
 		)); // add centered boxed line
 	}
 	// append bottom border
-	multiline_addline(multiline, strdup_checked(h_border)); // duplicate the existing h_border into the heap
-
-	free_wrap(fmt_type);
-	free_wrap(type);
-	free_wrap(fmt_name);
-	free_wrap(v_border);
-	free_wrap(h_border);
-	clear_wrapped(&wrapped_description);
-	clear_freeable_multiline(&effects_lines);
+	multiline_addline(multiline, h_border);
+
+	clear_multiline(&effects_lines);
 }
 
 /**
- * @brief builds and displays the card box of the given card
+ * @brief formats a card into a single line for the compact view: type, name and a summary of its effects
  * 
  * @param card pointer to the card
+ * @param len visual length of the line (out parameter)
+ * @return char* formatted line, in the scratch arena
  */
-void show_card(cartaT *card) {
-	freeable_multiline_textT card_info;
+char *build_compact_card(cartaT *card, int *len) {
+	char summary[FORMAT_LINE_LEN], type[FORMAT_LINE_LEN];
+	char *line;
+	int summary_len = 0;
+
+	format_buf(type, sizeof(type), "#%s", tipo_cartaT_str(card->tipo));
+	if (card->n_effetti == 0)
+		summary_len = format_buf(summary, sizeof(summary), "Nessun effetto");
+	else {
+		summary_len = format_buf(summary, sizeof(summary), "%s%s:", quandoT_str(card->quando), card->opzionale ? " (opzionale)" : "");
+		for (int i = 0; i < card->n_effetti; i++) {
+			summary_len += format_buf(summary + summary_len, sizeof(summary) - summary_len, i == 0 ? " " : ", ");
+			summary_len += format_effect(summary + summary_len, sizeof(summary) - summary_len, &card->effetti[i]);
+		}
+	}
+
+	line = format_scratch("%s%-*s" ANSI_RESET " " ANSI_BOLD "%-*s" ANSI_RESET " %s",
+		tipo_cartaT_color(card->tipo), COMPACT_TYPE_WIDTH, type,
+		CARTA_NAME_LEN, card->name,
+		summary
+	);
+	*len = string_width(line);
+	return line;
+}
+
+/**
+ * @brief finds the slot of the given card in the card render cache (the slot is empty if it was never rendered)
+ * 
+ * @param hash hash of the card name
+ * @param name name of the card
+ * @return card_renderT* pointer to the slot
+ */
+card_renderT *find_card_render(unsigned int hash, const char *name) {
+	int i = hash & (card_renders.n_slots-1);
+	while (card_renders.slots[i].hash != 0 && (card_renders.slots[i].hash != hash || strcmp(card_renders.slots[i].name, name) != 0))
+		i = (i+1) & (card_renders.n_slots-1); // linear probing
+	return &card_renders.slots[i];
+}
+
+/**
+ * @brief doubles the slots of the card render cache (allocates them on first use), rehashing the renders
+ * 
+ */
+void grow_card_renders(void) {
+	card_renderT *old_slots = card_renders.slots;
+	int old_n_slots = card_renders.n_slots;
+
+	card_renders.n_slots = old_n_slots == 0 ? CARD_RENDERS_MIN_SLOTS : old_n_slots*2;
+	card_renders.slots = (card_renderT*)calloc_checked(card_renders.n_slots, sizeof(card_renderT));
+	for (int i = 0; i < old_n_slots; i++) {
+		if (old_slots[i].hash != 0)
+			*find_card_render(old_slots[i].hash, old_slots[i].name) = old_slots[i];
+	}
+	free_wrap(old_slots);
+}
+
+/**
+ * @brief returns the rendering of the given card (box and compact line), building it on the first display of a card
+ * with its name. a card is identified by its name (like in the deck), so every copy of it shares the same lines.
+ * 
+ * @param card pointer to the card
+ * @return const card_renderT* rendering of the card, valid until clear_card_renders
+ */
+const card_renderT *render_card(cartaT *card) {
+	unsigned int hash = hash_string(card->name);
+	card_renderT *render;
+	scratch_markT mark;
+	multiline_textT card_info;
+	size_t size;
+	char *text, *compact;
+
+	hash = hash != 0 ? hash : 1; // 0 marks empty slots
+	if (card_renders.n_slots != 0) {
+		render = find_card_render(hash, card->name);
+		if (render->hash != 0)
+			return render;
+	}
+	if (2*(card_renders.n_renders+1) > card_renders.n_slots) // keep the cache at most half full
+		grow_card_renders();
+	render = find_card_render(hash, card->name);
+
+	// build the box in the scratch arena, then pack its lines in a single block
+	mark = scratch_mark();
 	init_multiline(&card_info);
 	build_card(&card_info, card);
+	compact = build_compact_card(card, &render->compact_len);
+	size = strlen(compact)+1;
 	for (int i = 0; i < card_info.n_lines; i++)
-		puts(card_info.lines[i]);
-	clear_freeable_multiline(&card_info);
+		size += strlen(card_info.lines[i])+1;
+
+	render->hash = hash;
+	strcpy(render->name, card->name);
+	render->text = text = (char*)malloc_checked(size);
+	render->box.n_lines = render->box.capacity = card_info.n_lines;
+	render->box.lines = (const char**)malloc_checked(card_info.n_lines*sizeof(char*));
+	render->box.lengths = (int*)malloc_checked(card_info.n_lines*sizeof(int));
+	for (int i = 0; i < card_info.n_lines; i++) {
+		size = strlen(card_info.lines[i])+1;
+		memcpy(text, card_info.lines[i], size);
+		render->box.lines[i] = text;
+		render->box.lengths[i] = card_info.lengths[i];
+		text += size;
+	}
+	strcpy(text, compact);
+	render->compact = text;
+	card_renders.n_renders++;
+
+	clear_multiline(&card_info);
+	scratch_release(mark);
+	return render;
 }
 
 /**
- * @brief displays a pretty-printed group of cards of the specified type to the terminal in a table
+ * @brief renders the box of every definition of the deck, so descriptions are wrapped once at deck load rather than
+ * during the game (cards of loaded games are still rendered at their first display)
+ * 
+ * @param deck pointer to the deck table
+ */
+void render_deck(deck_tableT *deck) {
+	for (int i = 0; i < deck->n_definitions; i++)
+		render_card(&deck->definitions[i]);
+}
+
+/**
+ * @brief frees every rendered card box of the card render cache
+ * 
+ */
+void clear_card_renders(void) {
+	for (int i = 0; i < card_renders.n_slots; i++) {
+		if (card_renders.slots[i].hash != 0) {
+			clear_multiline(&card_renders.slots[i].box);
+			free_wrap(card_renders.slots[i].text);
+		}
+	}
+	free_wrap(card_renders.slots);
+	card_renders.n_renders = card_renders.n_slots = 0;
+}
+
+/**
+ * @brief displays the card box of the given card
+ * 
+ * @param card pointer to the card
+ */
+void show_card(cartaT *card) {
+	const multiline_textT *card_info = &render_card(card)->box;
+	frame_begin();
+	for (int i = 0; i < card_info->n_lines; i++)
+		frame_puts(card_info->lines[i]);
+	frame_end();
+}
+
+/**
+ * @brief displays the cards of the specified type in the compact view, a line per card
  * 
  * @param head list of cards to display
  * @param type type of cards to restrict display of
  * @return true if any card was printed
  * @return false if no cards were shown
  */
-bool show_cards_restricted(cartaT *head, tipo_cartaT type) {
-	freeable_multiline_textT *cards_info;
-	int count = count_cards_restricted(head, type);
+bool show_compact_cards_restricted(cartaT *head, tipo_cartaT type) {
+	int count = 0;
+
+	frame_begin();
+	for (cartaT *card = head; card != NULL; card = card->next) {
+		if (match_card_type(card, type)) {
+			frame_pad(CARDS_HORIZONTAL_SPACING);
+			frame_puts(render_card(card)->compact);
+			count++;
+		}
+	}
+	if (count > 0)
+		frame_puts(""); // spacing after the list, like after each row of boxes
+	frame_end();
+
+	return count > 0;
+}
 
-	cards_info = (freeable_multiline_textT*)malloc_checked(count*sizeof(freeable_multiline_textT));
-	for (int i = 0; i < count; i++)
-		init_multiline(&cards_info[i]);
+/**
+ * @brief returns how many card boxes fit in a row of the terminal, with the spacing around them (at least one, a narrower
+ * terminal wraps it)
+ * 
+ * @return int cards per row
+ */
+int cards_per_row(void) {
+	int per_row = (get_terminal_size().columns - CARDS_HORIZONTAL_SPACING) / (CARD_WIDTH + CARDS_HORIZONTAL_SPACING);
+	return MAX(per_row, 1);
+}
 
-	for (int i = 0; i < count; head = head->next) {
-		if (match_card_type(head, type))
-			build_card(&cards_info[i++], head);
-	}
+/**
+ * @brief displays a pretty-printed group of cards of the specified type to the terminal in a table (or in a list in the
+ * compact view)
+ * 
+ * @param head list of cards to display
+ * @param type type of cards to restrict display of
+ * @return true if any card was printed
+ * @return false if no cards were shown
+ */
+bool show_cards_restricted(cartaT *head, tipo_cartaT type) {
+	cartaT *row = head, *card = NULL;
+	int count = 0, in_row = 0, per_row;
+
+	if (compact_view)
+		return show_compact_cards_restricted(head, type);
 
-	// actually print the built cards in rows containing CARDS_PER_ROW cards max each
-	for (int row = 0; row < (count + CARDS_PER_ROW-1)/CARDS_PER_ROW; row++) {
+	// actually print the cards in rows as wide as the terminal, walking the row once per line
+	per_row = cards_per_row();
+	frame_begin();
+	while (row != NULL) {
 		for (int y = 0; y < CARD_HEIGHT; y++) {
-			for (int i = row*CARDS_PER_ROW; i < MIN((row+1)*CARDS_PER_ROW, count); i++)
-				printf("%*s%s", CARDS_HORIZONTAL_SPACING, "", cards_info[i].lines[y]);
-			puts(""); // finished printing a line of the current row
+			in_row = 0;
+			for (card = row; card != NULL && in_row < per_row; card = card->next) {
+				if (match_card_type(card, type)) {
+					const char *line = render_card(card)->box.lines[y];
+					frame_pad(CARDS_HORIZONTAL_SPACING);
+					frame_write(line, strlen(line));
+					in_row++;
+				}
+			}
+			if (in_row != 0)
+				frame_puts(""); // finished printing a line of the current row
 		}
-		puts(""); // add spacing between each row
+		if (in_row != 0)
+			frame_puts(""); // add spacing between each row
+		count += in_row;
+		row = card; // first card after the row
 	}
+	frame_end();
 
-	for (int i = 0; i < count; i++)
-		clear_freeable_multiline(&cards_info[i]);
-	free_wrap(cards_info);
 	return count > 0;
 }
 
@@ -184,8 +360,19 @@ bool show_cards_restricted(cartaT *head, tipo_cartaT type) {
  * @return int maximum row width of the group of given cards
  */
 int get_max_row_width_restricted(cartaT *head, tipo_cartaT type) {
-	int width, max_row_count, count = count_cards_restricted(head, type);
-	max_row_count = count >= CARDS_PER_ROW ? CARDS_PER_ROW : count % CARDS_PER_ROW; // max(CARDS_PER_ROW, count % CARDS_PER_ROW)
+	int width = 0, max_row_count, count, per_row;
+
+	if (compact_view) { // a row is a single card
+		for (cartaT *card = head; card != NULL; card = card->next) {
+			if (match_card_type(card, type))
+				width = MAX(width, render_card(card)->compact_len);
+		}
+		return CARDS_HORIZONTAL_SPACING + MAX(width, CARD_WIDTH) + CARDS_HORIZONTAL_SPACING;
+	}
+
+	count = count_cards_restricted(head, type);
+	per_row = cards_per_row();
+	max_row_count = count >= per_row ? per_row : count; // min(per_row, count)
 
 	if (count == 0)
 		max_row_count = 1; // if no cards need to allocate 1 space anyway to fit "vuoto" placeholder
@@ -199,32 +386,33 @@ int get_max_row_width_restricted(cartaT *head, tipo_cartaT type) {
  * handing no cards to display case
  * 
  * @param group list of cards to display
- * @param title title of the group of cards (used to calculate visual length of title), can't contain colors
+ * @param title title of the group of cards
  * @param title_fmt title format string (must always contain one and only one %s and no other formatters), can contain colors
  * @param type type of cards to restrict display of
  */
 void show_card_group_restricted(cartaT *group, const char *title, const char *title_fmt, tipo_cartaT type) {
-	char *fmt_title;
+	char fmt_title[FORMAT_LINE_LEN];
 	int borders_width = strlen(CARDS_HEADER_LBORDER)+strlen(CARDS_HEADER_RBORDER);
 	int max_group_row_width = get_max_row_width_restricted(group, type);
 
-	asprintf_s(&fmt_title, title_fmt, title);
+	format_buf(fmt_title, sizeof(fmt_title), title_fmt, title);
 
-	puts(""); // spacing
+	frame_begin(); // the whole group is written at once
+	frame_screen();
+	frame_puts(""); // spacing
 	// show title header
-	print_centered_lr_boxed_string(fmt_title, strlen(title), CARDS_HEADER_LBORDER, CARDS_HEADER_RBORDER, max_group_row_width-borders_width);
+	print_centered_lr_boxed_string(fmt_title, CARDS_HEADER_LBORDER, CARDS_HEADER_RBORDER, max_group_row_width-borders_width);
 	// show cards group
 	if (!show_cards_restricted(group, type)) // if not any card shown just print the empty cards group box
-		print_centered_lr_boxed_string(CARDS_EMPTY_MSG, strlen(CARDS_EMPTY_MSG), "", "\n", max_group_row_width);
-
-	free_wrap(fmt_title);
+		print_centered_lr_boxed_string(CARDS_EMPTY_MSG, "", "\n", max_group_row_width);
+	frame_end();
 }
 
 /**
  * @brief displays a pretty-printed group of cards to the terminal in a table
  * 
  * @param group list of cards to display
- * @param title title of the group of cards (used to calculate visual length of title), can't contain colors
+ * @param title title of the group of cards
  * @param title_fmt title format string (must always contain one and only one %s and no other formatters), can contain colors
  */
 void show_card_group(cartaT *group, const char *title, const char *title_fmt) {
@@ -237,32 +425,31 @@ void show_card_group(cartaT *group, const char *title, const char *title_fmt) {
  * @param game_ctx current game state
  */
 void show_round(game_contextT *game_ctx) {
-	char *round_num_text, *player_turn_text;
-	int len_round_num_text, len_player_turn_text;
-	freeable_multiline_textT round_banner;
+	scratch_markT mark = scratch_mark();
+	char round_num_text[FORMAT_LINE_LEN], player_turn_text[FORMAT_LINE_LEN];
+	multiline_textT round_banner;
 	init_multiline(&round_banner);
 
-	len_round_num_text = snprintf(NULL, 0, "Round numero: %d", game_ctx->round_num);
-	asprintf_d(&round_num_text, "Round numero: " ANSI_BOLD "%d" ANSI_RESET, game_ctx->round_num);
+	format_buf(round_num_text, sizeof(round_num_text), "Round numero: " ANSI_BOLD "%d" ANSI_RESET, game_ctx->round_num);
 
-	len_player_turn_text = snprintf(NULL, 0, "Turno di: %s!", game_ctx->curr_player->name);
-	asprintf_s(&player_turn_text, "Turno di: " PRETTY_USERNAME "!", game_ctx->curr_player->name);
+	format_buf(player_turn_text, sizeof(player_turn_text), "Turno di: " PRETTY_USERNAME "!", game_ctx->curr_player->name);
 
 	// build actual banner
-	multiline_addline(&round_banner, strdup_checked(BANNER_HORIZONTAL_BORDER));
-	multiline_addline(&round_banner, center_boxed_string("", 0, BANNER_VERTICAL_BORDER, ROUND_BANNER_CONTENT_WIDTH)); // spacing
-	multiline_addline(&round_banner, center_boxed_string(round_num_text, len_round_num_text, BANNER_VERTICAL_BORDER, ROUND_BANNER_CONTENT_WIDTH));
-	multiline_addline(&round_banner, center_boxed_string(player_turn_text, len_player_turn_text, BANNER_VERTICAL_BORDER, ROUND_BANNER_CONTENT_WIDTH));
-	multiline_addline(&round_banner, center_boxed_string("", 0, BANNER_VERTICAL_BORDER, ROUND_BANNER_CONTENT_WIDTH)); // spacing
-	multiline_addline(&round_banner, strdup_checked(BANNER_HORIZONTAL_BORDER));
-
-	puts(""); // spacing
-	// print the whole banner
+	multiline_addline(&round_banner, BANNER_HORIZONTAL_BORDER);
+	multiline_addline(&round_banner, center_boxed_string("", BANNER_VERTICAL_BORDER, ROUND_BANNER_CONTENT_WIDTH)); // spacing
+	multiline_addline(&round_banner, center_boxed_string(round_num_text, BANNER_VERTICAL_BORDER, ROUND_BANNER_CONTENT_WIDTH));
+	multiline_addline(&round_banner, center_boxed_string(player_turn_text, BANNER_VERTICAL_BORDER, ROUND_BANNER_CONTENT_WIDTH));
+	multiline_addline(&round_banner, center_boxed_string("", BANNER_VERTICAL_BORDER, ROUND_BANNER_CONTENT_WIDTH)); // spacing
+	multiline_addline(&round_banner, BANNER_HORIZONTAL_BORDER);
+
+	// print the whole banner at once
+	frame_begin();
+	frame_puts(""); // spacing
 	for (int i = 0; i < round_banner.n_lines; i++)
-		puts(round_banner.lines[i]);
-	puts(""); // spacing
+		frame_puts(round_banner.lines[i]);
+	frame_puts(""); // spacing
+	frame_end();
 
-	free_wrap(player_turn_text);
-	free_wrap(round_num_text);
-	clear_freeable_multiline(&round_banner);
+	clear_multiline(&round_banner);
+	scratch_release(mark);
 }
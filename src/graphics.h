@@ -1,9 +1,16 @@
 #ifndef GRAPHICS_H
 #define GRAPHICS_H
 
+#include <stddef.h>
+#include <stdbool.h>
 #include "types.h"
 
-void format_effect(char **str, effettoT *effect);
+extern bool compact_view;
+
+int format_effect(char *buf, size_t size, effettoT *effect);
+const card_renderT *render_card(cartaT *card);
+void render_deck(deck_tableT *deck);
+void clear_card_renders(void);
 void show_card(cartaT *card);
 void show_card_group(cartaT *group, const char *title, const char *title_fmt);
 void show_card_group_restricted(cartaT *group, const char *title, const char *title_fmt, tipo_cartaT type);
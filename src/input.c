@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "input.h"
+#include "structs.h"
+#include "utils.h"
+
+replayT *active_replay = NULL; // game whose decisions are recorded or replayed, NULL if decisions are just asked
+
+/**
+ * @brief call this when the replayed game doesn't follow its recording. does not return.
+ * 
+ * @param reason what differs from the recording
+ */
+void replay_desync(const char *reason) {
+	fprintf(stderr, "Replay diverged from the recorded game at decision %u (%s)!\n", active_replay->n_decisions+1, reason);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief call this when writing a replay file fails. does not return.
+ * 
+ */
+void replay_write_failed(void) {
+	fputs("Writing replay file failed!\n", stderr);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief writes bytes to a replay, keeping them in memory until its file is opened
+ * 
+ * @param replay recorded replay
+ * @param data bytes to write
+ * @param size number of bytes
+ */
+void write_replay_bytes(replayT *replay, const void *data, size_t size) {
+	if (replay->file != NULL) {
+		if (fwrite(data, 1, size, replay->file) != size)
+			replay_write_failed();
+	} else {
+		if (replay->n_pending + size > replay->pending_capacity) {
+			replay->pending_capacity = replay->pending_capacity == 0 ? REPLAY_MIN_PENDING : replay->pending_capacity*2;
+			replay->pending_capacity = replay->pending_capacity < replay->n_pending + size ? replay->n_pending + size : replay->pending_capacity;
+			replay->pending = (unsigned char*)realloc_checked(replay->pending, replay->pending_capacity);
+		}
+		memcpy(&replay->pending[replay->n_pending], data, size);
+		replay->n_pending += size;
+	}
+}
+
+/**
+ * @brief writes an unsigned value as a varint (7 bits per byte, least significant first, high bit set on every byte
+ * but the last), so small values such as menu choices take a single byte
+ * 
+ * @param replay recorded replay
+ * @param value value to write
+ */
+void write_replay_varint(replayT *replay, unsigned long long value) {
+	unsigned char bytes[REPLAY_VARINT_MAX];
+	size_t len = 0;
+
+	while (value >= 0x80) {
+		bytes[len++] = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+	bytes[len++] = (unsigned char)value;
+	write_replay_bytes(replay, bytes, len);
+}
+
+/**
+ * @brief reads a varint written by write_replay_varint
+ * 
+ * @param replay replayed replay
+ * @param value read value (out parameter)
+ * @return true if a whole varint was read
+ * @return false if the file ended or the varint is malformed
+ */
+bool read_replay_varint(replayT *replay, unsigned long long *value) {
+	int byte, shift = 0;
+
+	*value = 0;
+	do {
+		byte = getc(replay->file);
+		if (byte == EOF || shift >= 64)
+			return false;
+		*value |= (unsigned long long)(byte & 0x7F) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+	return true;
+}
+
+/**
+ * @brief writes a record tag: its kind in the low REPLAY_KIND_BITS bits and its zigzag encoded value (sign in the
+ * lowest bit, so small negative values stay short) above them
+ * 
+ * @param replay recorded replay
+ * @param kind record kind
+ * @param value record value
+ */
+void write_replay_value(replayT *replay, replay_kindT kind, long long value) {
+	unsigned long long zigzag = value < 0 ? ((unsigned long long)-(value+1) << 1) | 1 : (unsigned long long)value << 1;
+	write_replay_varint(replay, zigzag << REPLAY_KIND_BITS | kind);
+}
+
+/**
+ * @brief reads a record tag written by write_replay_value, the replay diverges if it is of another kind
+ * 
+ * @param replay replayed replay
+ * @param kind expected record kind
+ * @return long long record value
+ */
+long long read_replay_value(replayT *replay, replay_kindT kind) {
+	unsigned long long tag, zigzag;
+
+	if (!read_replay_varint(replay, &tag))
+		replay_desync("the recording ends here");
+	if ((replay_kindT)(tag & ((1 << REPLAY_KIND_BITS) - 1)) != kind)
+		replay_desync(kind == REPLAY_END ? "the game ended before the recording" : "the recorded decision is of another kind");
+
+	zigzag = tag >> REPLAY_KIND_BITS;
+	return zigzag & 1 ? -(long long)(zigzag >> 1) - 1 : (long long)(zigzag >> 1);
+}
+
+/**
+ * @brief records a decision of the recorded game, if any. each decision is flushed, so the recording of a game
+ * terminated abruptly can still be replayed up to its last decision.
+ * 
+ * @param kind decision kind
+ * @param value decision value
+ * @param text line of a REPLAY_TEXT decision, whose value is its length, NULL otherwise
+ */
+void record_decision(replay_kindT kind, long long value, const char *text) {
+	if (active_replay == NULL)
+		return;
+
+	write_replay_value(active_replay, kind, value);
+	if (text != NULL)
+		write_replay_bytes(active_replay, text, (size_t)value);
+	active_replay->n_decisions++;
+	if (active_replay->file != NULL)
+		fflush(active_replay->file);
+}
+
+/**
+ * @brief prompts user to insert an integer from standard input, doesn't return until an integer is supplied.
+ * when replaying, the recorded integer is returned instead.
+ * 
+ * @return int inserted integer
+ */
+int get_int(void) {
+	printf("> ");
+	int val;
+	if (active_replay != NULL && active_replay->playing) {
+		val = (int)read_replay_value(active_replay, REPLAY_INT);
+		active_replay->n_decisions++;
+		return val;
+	}
+
+	while (scanf(" %d", &val) != ONE_ELEMENT)
+		getchar();
+	record_decision(REPLAY_INT, val, NULL);
+	return val;
+}
+
+/**
+ * @brief prompts user to make a yes or no choice. when replaying, the recorded choice is returned instead.
+ * 
+ * @return true if user chose yes
+ * @return false if user chose no
+ */
+bool ask_choice(void) {
+	char choice = 'n';
+	bool yes;
+	printf("(" ANSI_GREEN "y" ANSI_RESET "/" ANSI_RED "N" ANSI_RESET "): ");
+	if (active_replay != NULL && active_replay->playing) {
+		yes = read_replay_value(active_replay, REPLAY_CHOICE) != 0;
+		active_replay->n_decisions++;
+		return yes;
+	}
+
+	scanf(" %c", &choice);
+	yes = choice == 'y' || choice == 'Y';
+	record_decision(REPLAY_CHOICE, yes, NULL);
+	return yes;
+}
+
+/**
+ * @brief reads a line from standard input with the given scanf format. when replaying, the recorded line is copied
+ * instead.
+ * 
+ * @param format scanf format reading a single string, bounded to size-1 characters
+ * @param str buffer receiving the line
+ * @param size size of the buffer
+ * @return true if a line was read
+ * @return false if the format didn't match
+ */
+bool get_text(const char *format, char *str, size_t size) {
+	long long len;
+
+	if (active_replay != NULL && active_replay->playing) {
+		len = read_replay_value(active_replay, REPLAY_TEXT);
+		if (len < 0 || (size_t)len >= size || fread(str, 1, (size_t)len, active_replay->file) != (size_t)len)
+			replay_desync("the recorded line doesn't fit");
+		str[len] = '\0';
+		active_replay->n_decisions++;
+		return true;
+	}
+
+	if (scanf(format, str) != ONE_ELEMENT)
+		return false;
+	record_decision(REPLAY_TEXT, (long long)strlen(str), str);
+	return true;
+}
@@ -0,0 +1,20 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "types.h"
+
+extern replayT *active_replay;
+
+int get_int(void);
+bool ask_choice(void);
+bool get_text(const char *format, char *str, size_t size);
+
+void replay_desync(const char *reason);
+void write_replay_varint(replayT *replay, unsigned long long value);
+bool read_replay_varint(replayT *replay, unsigned long long *value);
+void write_replay_value(replayT *replay, replay_kindT kind, long long value);
+long long read_replay_value(replayT *replay, replay_kindT kind);
+
+#endif // INPUT_H
\ No newline at end of file
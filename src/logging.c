@@ -1,107 +1,379 @@
+#define _POSIX_C_SOURCE 200809L // nanosleep
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
 #include "logging.h"
 #include "files.h"
-#include "format.h"
 #include "utils.h"
 
+loggerT *active_logger = NULL; // logger drained at exit, in case the game terminates without shutting logging down
+
 /**
- * @brief write a message to logs
+ * @brief call this when the logging thread can't be started. does not return.
  * 
- * @param game_ctx current game state
- * @param msg message
  */
-void log_msg(game_contextT *game_ctx, const char *msg) {
-	fprintf(game_ctx->log_file, "%s\n", msg);
+void logging_failed(void) {
+	fputs("Starting the logging thread failed!\n", stderr);
+	exit(EXIT_FAILURE);
 }
 
 /**
- * @brief intializes logging for the given game context
+ * @brief sleeps the writer thread while there are no pending records
  * 
- * @param game_ctx current game state
  */
-void init_logging(game_contextT *game_ctx) {
-	game_ctx->log_file = open_log_append();
-	log_msg(game_ctx, "Avvio del logging...");
+void log_writer_idle(void) {
+#ifdef _WIN32
+	Sleep(LOG_WRITER_IDLE_NS / 1000000);
+#else
+	struct timespec idle = { 0, LOG_WRITER_IDLE_NS };
+	nanosleep(&idle, NULL);
+#endif
+}
+
+/**
+ * @brief compressor thread body: compresses the log file rotated by init_logging in its own thread, so that the writer
+ * keeps draining the ring meanwhile and the game never waits for it
+ * 
+ * @param arg pointer to the logger
+ * @return void* always NULL
+ */
+void *log_compressor(void *arg) {
+	compress_log_segment(((loggerT*)arg)->compress_path);
+	return NULL;
 }
 
 /**
- * @brief shuts down logging for the given game context
+ * @brief writer thread body: writes the pending records as they are, in batches (at most two writes per batch as the
+ * ring wraps, flushing once), until the logger is stopped and the ring is drained.
+ * the writer only yields for the first LOG_WRITER_SPINS polls without records, so bursts of events don't fill the ring.
+ * once writing the log file fails (e.g. the disk is full) the failure is reported once and the following records are
+ * discarded instead of written, still releasing their slots so that the game never waits for the writer.
+ * 
+ * @param arg pointer to the logger
+ * @return void* always NULL
+ */
+void *log_writer(void *arg) {
+	loggerT *logger = (loggerT*)arg;
+	unsigned int head, tail = logger->tail, start, count, idle_polls = 0;
+	bool running, failed = false, reported = false;
+
+	for (;;) {
+		// running must be read before head: once stopped, head can't move anymore
+		running = __atomic_load_n(&logger->running, __ATOMIC_ACQUIRE);
+		head = __atomic_load_n(&logger->head, __ATOMIC_ACQUIRE);
+
+		if (tail != head) {
+			idle_polls = 0;
+			while (tail != head) {
+				start = tail & (LOG_RING_SIZE-1);
+				count = MIN(head - tail, LOG_RING_SIZE - start); // contiguous records up to the end of the ring
+				failed = failed || fwrite(&logger->records[start], sizeof(log_recordT), count, logger->file) != count;
+				tail += count;
+			}
+			__atomic_store_n(&logger->tail, tail, __ATOMIC_RELEASE); // release the written slots to the game thread
+			failed = failed || fflush(logger->file) != 0;
+			if (failed && !reported) {
+				fprintf(stderr, "Writing logs file (%s) failed, logging stopped!\n", FILE_LOG);
+				reported = true;
+			}
+		} else if (!running)
+			break;
+		else if (idle_polls++ < LOG_WRITER_SPINS)
+			sched_yield();
+		else
+			log_writer_idle();
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief reserves the next record of the ring. called only by the game thread (single producer), the record is
+ * handed to the writer thread by log_publish.
+ * 
+ * @param logger current logger
+ * @return log_recordT* zeroed record to fill
+ */
+log_recordT *log_reserve(loggerT *logger) {
+	log_recordT *record;
+
+	while (logger->head - __atomic_load_n(&logger->tail, __ATOMIC_ACQUIRE) == LOG_RING_SIZE)
+		sched_yield(); // ring is full: let the writer thread catch up
+
+	record = &logger->records[logger->head & (LOG_RING_SIZE-1)];
+	memset(record, 0, sizeof(log_recordT));
+	return record;
+}
+
+/**
+ * @brief publishes the record returned by the last log_reserve to the writer thread
+ * 
+ * @param logger current logger
+ */
+void log_publish(loggerT *logger) {
+	__atomic_store_n(&logger->head, logger->head+1, __ATOMIC_RELEASE); // only this thread writes head
+}
+
+/**
+ * @brief pushes a dictionary record followed by its string, copied in record-sized chunks
+ * 
+ * @param logger current logger
+ * @param record filled dictionary record, its other_card field is set to the string length
+ * @param str string declared by the record
+ */
+void log_push_string(loggerT *logger, log_recordT *record, const char *str) {
+	size_t len = strlen(str);
+
+	record->other_card = (unsigned int)len;
+	*log_reserve(logger) = *record;
+	log_publish(logger);
+	for (size_t pos = 0; pos < len; pos += sizeof(log_recordT)) {
+		memcpy(log_reserve(logger), &str[pos], MIN(len - pos, sizeof(log_recordT)));
+		log_publish(logger);
+	}
+}
+
+/**
+ * @brief finds the seat of a player declared by log_players
+ * 
+ * @param logger current logger
+ * @param player player to look for, can be NULL
+ * @return unsigned char seat of the player or LOG_NO_SEAT
+ */
+unsigned char log_seat(loggerT *logger, giocatoreT *player) {
+	for (int seat = 0; seat < logger->n_seats && player != NULL; seat++) {
+		if (logger->seats[seat] == player)
+			return (unsigned char)seat;
+	}
+	return LOG_NO_SEAT;
+}
+
+/**
+ * @brief computes the id of a card (hash of its name, which identifies it), declaring the card with a LOG_EV_CARD
+ * record the first time it is seen in this session
+ * 
+ * @param logger current logger
+ * @param card card to identify, can be NULL
+ * @return unsigned int card id, 0 if card is NULL
+ */
+unsigned int log_card_id(loggerT *logger, cartaT *card) {
+	unsigned int id, slot;
+	bool known = false;
+	log_recordT record;
+
+	if (card == NULL)
+		return 0;
+
+	id = hash_string(card->name);
+	id = id == 0 ? 1 : id; // 0 means no card
+	slot = id & (LOG_KNOWN_CARDS-1);
+	for (int probes = 0; probes < LOG_KNOWN_CARDS && !known && logger->known_cards[slot] != 0; probes++) {
+		known = logger->known_cards[slot] == id;
+		if (!known)
+			slot = (slot + 1) & (LOG_KNOWN_CARDS-1);
+	}
+
+	if (!known) {
+		logger->known_cards[slot] = id; // when the set is full a card is just declared again, which is harmless
+		memset(&record, 0, sizeof(log_recordT));
+		record.type = LOG_EV_CARD;
+		record.actor = record.target = LOG_NO_SEAT;
+		record.card_type = (unsigned char)card->tipo;
+		record.effect = (unsigned char)card->quando;
+		record.card = id;
+		log_push_string(logger, &record, card->name);
+	}
+	return id;
+}
+
+/**
+ * @brief declares the save path of the game with a LOG_EV_SAVE_PATH record, unless already declared
  * 
  * @param game_ctx current game state
  */
-void shutdown_logging(game_contextT *game_ctx) {
-	log_msg(game_ctx, "Arresto del logging...");
-	fclose(game_ctx->log_file);
+void log_save_path(game_contextT *game_ctx) {
+	log_recordT record;
+
+	if (game_ctx->save_path != NULL && game_ctx->logger->logged_save_path != game_ctx->save_path) {
+		memset(&record, 0, sizeof(log_recordT));
+		record.type = LOG_EV_SAVE_PATH;
+		record.actor = record.target = LOG_NO_SEAT;
+		log_push_string(game_ctx->logger, &record, game_ctx->save_path);
+		game_ctx->logger->logged_save_path = game_ctx->save_path;
+	}
 }
 
 /**
- * @brief writes a round message to logs
+ * @brief writes an event to logs as a fixed-size record, without formatting it (see tools/log_print.c).
+ * players are stored as seats and cards as ids, arguments not used by the event type are ignored when printing.
  * 
  * @param game_ctx current game state
- * @param msg message
+ * @param type event type
+ * @param actor player performing the action, can be NULL
+ * @param target player targeted by the action, can be NULL
+ * @param card main card of the event, can be NULL
+ * @param other_card secondary card of the event (e.g. the card used to defend), can be NULL
+ * @param card_type type of cards involved in the event (e.g. target of an effect)
+ * @param effect effect involved in the event, can be NULL
  */
-void log_round(game_contextT *game_ctx, const char *msg) {
-	fprintf(game_ctx->log_file, "[Turno %d] %s\n", game_ctx->round_num, msg);
+void log_event(game_contextT *game_ctx, log_event_typeT type, giocatoreT *actor, giocatoreT *target, cartaT *card,
+	cartaT *other_card, tipo_cartaT card_type, effettoT *effect) {
+	loggerT *logger = game_ctx->logger;
+	unsigned int card_id, other_card_id;
+	log_recordT *record;
+
+	// dictionary records must precede the event referencing them
+	if (type == LOG_EV_SAVE)
+		log_save_path(game_ctx);
+	card_id = log_card_id(logger, card);
+	other_card_id = log_card_id(logger, other_card);
+
+	record = log_reserve(logger);
+	record->type = (unsigned char)type;
+	record->actor = log_seat(logger, actor);
+	record->target = log_seat(logger, target);
+	record->card_type = (unsigned char)card_type;
+	if (effect != NULL) {
+		record->effect = (unsigned char)effect->azione;
+		record->effect_players = (unsigned char)effect->target_giocatori;
+	}
+	record->round_num = (unsigned short)game_ctx->round_num;
+	record->card = card_id;
+	record->other_card = other_card_id;
+	log_publish(logger);
 }
 
 /**
- * @brief writes a formatted round message to logs with one string parameter
+ * @brief writes an event carrying a value instead of cards to logs
  * 
  * @param game_ctx current game state
- * @param fmt format string
- * @param s0 param 1 (string)
+ * @param type event type
+ * @param actor player the event refers to, can be NULL
+ * @param value value stored by the event (e.g. cards count of LOG_EV_DECK_LOADED), 0 if unused
  */
-void log_s(game_contextT *game_ctx, const char *fmt, const char *s0) {
-	char *msg;
-	asprintf_s(&msg, fmt, s0);
-	log_round(game_ctx, msg);
-	free_wrap(msg);
+void log_value(game_contextT *game_ctx, log_event_typeT type, giocatoreT *actor, unsigned int value) {
+	log_recordT *record;
+
+	if (type == LOG_EV_LOAD_GAME)
+		log_save_path(game_ctx);
+
+	record = log_reserve(game_ctx->logger);
+	record->type = (unsigned char)type;
+	record->actor = log_seat(game_ctx->logger, actor);
+	record->target = LOG_NO_SEAT;
+	record->round_num = (unsigned short)game_ctx->round_num;
+	record->card = type == LOG_EV_START ? LOG_MAGIC : 0; // lets the printer recognize log files and sessions
+	record->other_card = value;
+	log_publish(game_ctx->logger);
 }
 
 /**
- * @brief writes a formatted round message to logs with two string parameters
+ * @brief declares the players of the game with LOG_EV_PLAYER records, in turn order starting from the current player.
+ * call this once players are created or loaded, following events refer to players by their seat.
  * 
  * @param game_ctx current game state
- * @param fmt format string
- * @param s0 param 1 (string)
- * @param s1 param 2 (string)
  */
-void log_ss(game_contextT *game_ctx, const char *fmt, const char *s0, const char *s1) {
-	char *msg;
-	asprintf_ss(&msg, fmt, s0, s1);
-	log_round(game_ctx, msg);
-	free_wrap(msg);
+void log_players(game_contextT *game_ctx) {
+	loggerT *logger = game_ctx->logger;
+	giocatoreT *player = game_ctx->curr_player;
+	log_recordT record;
+
+	if (logger == NULL) // logging is off
+		return;
+
+	logger->n_seats = game_ctx->n_players;
+	for (int seat = 0; seat < logger->n_seats; seat++, player = player->next) {
+		logger->seats[seat] = player;
+		memset(&record, 0, sizeof(log_recordT));
+		record.type = LOG_EV_PLAYER;
+		record.actor = (unsigned char)seat;
+		record.target = LOG_NO_SEAT;
+		log_push_string(logger, &record, player->name);
+	}
+}
+
+/**
+ * @brief stops the writer thread of a logger after it drained the pending records and waits for the rotated log file to
+ * be compressed (never leaving a partially compressed segment behind), then closes the log file
+ * 
+ * @param logger logger to stop
+ */
+void stop_logger(loggerT *logger) {
+	__atomic_store_n(&logger->running, false, __ATOMIC_RELEASE);
+	pthread_join(logger->writer, NULL);
+	if (logger->compress_path != NULL)
+		pthread_join(logger->compressor, NULL);
+	fclose(logger->file); // releases the shared lock once the segment is compressed, letting other sessions rotate
+	free_wrap(logger->compress_path);
+}
+
+/**
+ * @brief atexit handler, writes the pending records if the game terminates while logging is active
+ * 
+ */
+void drain_active_logger(void) {
+	if (active_logger != NULL) {
+		stop_logger(active_logger);
+		free_wrap(active_logger);
+		active_logger = NULL;
+	}
 }
 
 /**
- * @brief writes a formatted round message to logs with three string parameters
+ * @brief intializes logging for the given game context with the level and categories chosen from command-line,
+ * starting the writer thread unless logging is off. a log file over the chosen size is rotated first, so every
+ * session (a game) starts in the log file and is never split across segments.
  * 
  * @param game_ctx current game state
- * @param fmt format string
- * @param s0 param 1 (string)
- * @param s1 param 2 (string)
- * @param s2 param 3 (string)
+ * @param options command-line options
  */
-void log_sss(game_contextT *game_ctx, const char *fmt, const char *s0, const char *s1, const char *s2) {
-	char *msg;
-	asprintf_sss(&msg, fmt, s0, s1, s2);
-	log_round(game_ctx, msg);
-	free_wrap(msg);
+void init_logging(game_contextT *game_ctx, const launch_optionsT *options) {
+	static bool drain_registered = false;
+	loggerT *logger;
+	bool rotated;
+
+	// levels compiled away can't be enabled at runtime
+	game_ctx->log_level = options->log_level < LOG_COMPILE_LEVEL ? LOG_COMPILE_LEVEL : options->log_level;
+	game_ctx->log_categories = options->log_categories;
+	game_ctx->logger = NULL;
+	if (game_ctx->log_level == LOG_LEVEL_OFF)
+		return;
+
+	logger = (loggerT*)calloc_checked(ONE_ELEMENT, sizeof(loggerT));
+	logger->file = open_log_session(options->log_max_size, options->log_segments, &rotated);
+	if (rotated && options->log_compress)
+		logger->compress_path = get_log_segment_path(1, false);
+	setvbuf(logger->file, NULL, _IOFBF, LOG_WRITE_BUFFER_SIZE);
+	logger->running = true;
+	if (pthread_create(&logger->writer, NULL, log_writer, logger) != 0)
+		logging_failed();
+	if (logger->compress_path != NULL && pthread_create(&logger->compressor, NULL, log_compressor, logger) != 0)
+		logging_failed();
+
+	game_ctx->logger = active_logger = logger;
+	if (!drain_registered)
+		drain_registered = atexit(drain_active_logger) == 0;
+
+	log_value(game_ctx, LOG_EV_START, NULL, LOG_VERSION);
 }
 
 /**
- * @brief writes a formatted round message to logs with four string parameters
+ * @brief shuts down logging for the given game context, waiting for the pending records to be written
  * 
  * @param game_ctx current game state
- * @param fmt format string
- * @param s0 param 1 (string)
- * @param s1 param 2 (string)
- * @param s2 param 3 (string)
- * @param s3 param 4 (string)
- */
-void log_ssss(game_contextT *game_ctx, const char *fmt, const char *s0, const char *s1, const char *s2, const char *s3) {
-	char *msg;
-	asprintf_ssss(&msg, fmt, s0, s1, s2, s3);
-	log_round(game_ctx, msg);
-	free_wrap(msg);
-}
\ No newline at end of file
+ */
+void shutdown_logging(game_contextT *game_ctx) {
+	if (game_ctx->logger == NULL) // logging is off
+		return;
+
+	log_value(game_ctx, LOG_EV_STOP, NULL, 0);
+	stop_logger(game_ctx->logger);
+	if (active_logger == game_ctx->logger)
+		active_logger = NULL;
+	free_wrap(game_ctx->logger);
+}
@@ -4,13 +4,28 @@
 #include "types.h"
 #include "structs.h"
 
-void init_logging(game_contextT *game_ctx);
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DETAIL // events below this level are compiled away (make LOG_LEVEL=...)
+#endif
+
+// checked before evaluating any argument of the event: with constant level and category, events below
+// LOG_COMPILE_LEVEL are removed by the compiler
+#define LOG_ENABLED(game_ctx, level, category) \
+	((level) >= LOG_COMPILE_LEVEL && (level) >= (game_ctx)->log_level && ((game_ctx)->log_categories & (category)))
+
+// writes an event (see log_event) if its level and category are enabled
+#define LOG_EVENT(game_ctx, level, category, ...) \
+	do { if (LOG_ENABLED(game_ctx, level, category)) log_event(game_ctx, __VA_ARGS__); } while (0)
+
+// writes an event carrying a value (see log_value) if its level and category are enabled
+#define LOG_VALUE(game_ctx, level, category, ...) \
+	do { if (LOG_ENABLED(game_ctx, level, category)) log_value(game_ctx, __VA_ARGS__); } while (0)
+
+void init_logging(game_contextT *game_ctx, const launch_optionsT *options);
 void shutdown_logging(game_contextT *game_ctx);
-void log_msg(game_contextT *game_ctx, const char *msg);
-void log_round(game_contextT *game_ctx, const char *msg);
-void log_s(game_contextT *game_ctx, const char *fmt, const char *s0);
-void log_ss(game_contextT *game_ctx, const char *fmt, const char *s0, const char *s1);
-void log_sss(game_contextT *game_ctx, const char *fmt, const char *s0, const char *s1, const char *s2);
-void log_ssss(game_contextT *game_ctx, const char *fmt, const char *s0, const char *s1, const char *s2, const char *s3);
+void log_players(game_contextT *game_ctx);
+void log_value(game_contextT *game_ctx, log_event_typeT type, giocatoreT *actor, unsigned int value);
+void log_event(game_contextT *game_ctx, log_event_typeT type, giocatoreT *actor, giocatoreT *target, cartaT *card,
+	cartaT *other_card, tipo_cartaT card_type, effettoT *effect);
 
 #endif // LOGGING_H
\ No newline at end of file
@@ -2,14 +2,167 @@
 // Matricola: 60/61/66678
 // Tipologia progetto: avanzato
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <limits.h>
 #include "types.h"
 #include "structs.h"
 #include "gameplay.h"
 #include "menu.h"
 #include "game.h"
 #include "stats.h"
+#include "utils.h"
+#include "replay.h"
+#include "tui.h"
+#include "graphics.h"
+
+/**
+ * @brief call this when a command-line option is missing its value. does not return.
+ * 
+ * @param option option missing its value
+ */
+void missing_option_value(const char *option) {
+	fprintf(stderr, "Missing value after %s option!\n", option);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief parses a log level name (dettaglio, turno, sessione or nessuno)
+ * 
+ * @param name log level name
+ * @return log_levelT corresponding log level
+ */
+log_levelT parse_log_level(const char *name) {
+	const char *names[] = {
+		[LOG_LEVEL_DETAIL] = "dettaglio",
+		[LOG_LEVEL_ROUND] = "turno",
+		[LOG_LEVEL_SESSION] = "sessione",
+		[LOG_LEVEL_OFF] = "nessuno"
+	};
+
+	for (int level = LOG_LEVEL_DETAIL; level <= LOG_LEVEL_OFF; level++) {
+		if (!strcmp(name, names[level]))
+			return (log_levelT)level;
+	}
+	fprintf(stderr, "Unknown log level (%s)!\n", name);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief parses a comma separated list of log category names (sessione, turno, carte, effetti, difese)
+ * 
+ * @param list log categories list
+ * @return int mask of the log categories
+ */
+int parse_log_categories(const char *list) {
+	const char *names[] = { "sessione", "turno", "carte", "effetti", "difese" }; // in LogCategory bits order
+	int categories = 0, found;
+	size_t len;
+
+	while (*list != '\0') {
+		len = strcspn(list, ",");
+		found = -1;
+		for (int i = 0; i < (int)(sizeof(names)/sizeof(names[0])) && found == -1; i++) {
+			if (strlen(names[i]) == len && !strncmp(list, names[i], len))
+				found = i;
+		}
+		if (found == -1) {
+			fprintf(stderr, "Unknown log category (%.*s)!\n", (int)len, list);
+			exit(EXIT_FAILURE);
+		}
+		categories |= 1 << found;
+		list += list[len] == ',' ? len+1 : len;
+	}
+	return categories;
+}
+
+/**
+ * @brief parses the non-negative integer value of a command-line option
+ * 
+ * @param option option the value belongs to
+ * @param value value to parse
+ * @return int parsed value
+ */
+int parse_option_count(const char *option, const char *value) {
+	char *end;
+	long count = strtol(value, &end, 10);
+
+	if (end == value || *end != '\0' || count < 0 || count > INT_MAX) {
+		fprintf(stderr, "Invalid value for %s option (%s)!\n", option, value);
+		exit(EXIT_FAILURE);
+	}
+	return (int)count;
+}
+
+/**
+ * @brief parses command-line arguments, every option is optional:
+ * - OPTION_DECK followed by the base deck file
+ * - OPTION_EXPANSION followed by an expansion pack file, repeatable
+ * - OPTION_LOG_LEVEL followed by the log level
+ * - OPTION_LOG_CATEGORIES followed by the log categories
+ * - OPTION_LOG_MAX_SIZE followed by the log rotation size (KB)
+ * - OPTION_LOG_SEGMENTS followed by the rotated log files count
+ * - OPTION_LOG_COMPRESS, OPTION_TUI and OPTION_COMPACT
+ * - OPTION_REPLAY followed by the save whose recorded game is replayed
+ * - the save name to load
+ * 
+ * @param options parsed options (out parameter)
+ * @param argc command line arguments count
+ * @param argv pointer to command line arguments array
+ */
+void parse_options(launch_optionsT *options, int argc, const char *argv[]) {
+	options->save_name = options->deck_path = options->replay_name = NULL;
+	options->n_expansions = 0;
+	options->log_level = LOG_LEVEL_DETAIL;
+	options->log_categories = LOG_CAT_ALL;
+	options->log_max_size = LOG_DEFAULT_MAX_SIZE * 1024LL;
+	options->log_segments = LOG_DEFAULT_SEGMENTS;
+	options->log_compress = false;
+	options->tui = false;
+	options->compact = false;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], OPTION_LOG_LEVEL) || !strcmp(argv[i], OPTION_LOG_CATEGORIES)) {
+			if (i+1 == argc)
+				missing_option_value(argv[i]);
+			if (!strcmp(argv[i], OPTION_LOG_LEVEL))
+				options->log_level = parse_log_level(argv[++i]);
+			else
+				options->log_categories = parse_log_categories(argv[++i]);
+		} else if (!strcmp(argv[i], OPTION_LOG_MAX_SIZE) || !strcmp(argv[i], OPTION_LOG_SEGMENTS)) {
+			if (i+1 == argc)
+				missing_option_value(argv[i]);
+			if (!strcmp(argv[i], OPTION_LOG_MAX_SIZE))
+				options->log_max_size = parse_option_count(OPTION_LOG_MAX_SIZE, argv[++i]) * 1024LL;
+			else
+				options->log_segments = parse_option_count(OPTION_LOG_SEGMENTS, argv[++i]);
+		} else if (!strcmp(argv[i], OPTION_LOG_COMPRESS)) {
+			options->log_compress = true;
+		} else if (!strcmp(argv[i], OPTION_TUI)) {
+			options->tui = true;
+		} else if (!strcmp(argv[i], OPTION_COMPACT)) {
+			options->compact = true;
+		} else if (!strcmp(argv[i], OPTION_REPLAY)) {
+			if (i+1 == argc)
+				missing_option_value(argv[i]);
+			options->replay_name = argv[++i];
+		} else if (!strcmp(argv[i], OPTION_DECK) || !strcmp(argv[i], OPTION_EXPANSION)) {
+			if (i+1 == argc)
+				missing_option_value(argv[i]);
+			if (!strcmp(argv[i], OPTION_DECK))
+				options->deck_path = argv[++i];
+			else if (options->n_expansions < MAX_DECK_PACKS-1)
+				options->expansion_paths[options->n_expansions++] = argv[++i];
+			else {
+				fputs("Too many expansion packs (max " TO_STRING(MAX_DECK_PACKS) " deck packs)!\n", stderr);
+				exit(EXIT_FAILURE);
+			}
+		} else
+			options->save_name = argv[i]; // save name is passed as plain command-line argument
+	}
+}
 
 /**
  * @brief main function, entry point for execution of the program
@@ -20,25 +173,21 @@
  */
 int main(int argc, const char *argv[]) {
 	game_contextT *game_ctx;
+	launch_optionsT options;
 
 	// seed libc random generator
 	srand(time(NULL));
 	
-	// check salvataggio
-	if (argc == ONE_ELEMENT) // no additional arguments are passed
-		game_ctx = main_menu(NULL);
-	else
-		game_ctx = main_menu(argv[1]); // save path is passed as first command-line argument
+	parse_options(&options, argc, argv);
+	if (options.replay_name != NULL) // headless replay of a recorded game, then quit
+		return replay_game(&options) ? EXIT_SUCCESS : EXIT_FAILURE;
+	if (options.tui)
+		start_tui();
+	compact_view = options.compact;
 
-	// game loop
-	game_ctx->game_running = true;
-	while (game_ctx->game_running) {
-		begin_round(game_ctx);
+	game_ctx = main_menu(&options);
 
-		play_round(game_ctx);
-
-		end_round(game_ctx);
-	}
+	play_game(game_ctx);
 
 	save_stats(game_ctx);
 	clear_game(game_ctx);
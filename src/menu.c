@@ -1,18 +1,21 @@
 #include <stdlib.h>
 #include "menu.h"
 #include "utils.h"
+#include "input.h"
 #include "files.h"
 #include "game.h"
 #include "saves.h"
 #include "stats.h"
+#include "frame.h"
 
 /**
  * @brief instantiates game context based on user choice to load an existing save or create a new one. allows to show global stats.
  * 
- * @param provided_save save file to try loading from SAVES_DIRECTORY directory (without SAVE_PATH_EXTENSION extension)
+ * @param options command-line options: save file to try loading from SAVES_DIRECTORY directory (without
+ * SAVE_PATH_EXTENSION extension), base deck and expansion packs for new games
  * @return game_contextT* newly created game context
  */
-game_contextT *main_menu(const char *provided_save) {
+game_contextT *main_menu(const launch_optionsT *options) {
 	int option;
 	char *save_name;
 	game_contextT *game_ctx;
@@ -20,26 +23,27 @@ game_contextT *main_menu(const char *provided_save) {
 
 	puts(MENU_ASCII_ART);
 
-	if (provided_save == NULL) {
+	if (options->save_name == NULL) {
 		while (in_menu) {
 			do {
-				puts("[" TO_STRING(MENU_NEWGAME) "] Avvia una nuova partita");
-				puts("[" TO_STRING(MENU_LOADSAVE) "] Carica un salvataggio");
-				puts("[" TO_STRING(MENU_STATS) "] Consulta le statistiche");
-				puts("[" TO_STRING(MENU_QUIT) "] Esci dal gioco");
+				// a single string, written at once
+				frame_puts("[" TO_STRING(MENU_NEWGAME) "] Avvia una nuova partita\n"
+					"[" TO_STRING(MENU_LOADSAVE) "] Carica un salvataggio\n"
+					"[" TO_STRING(MENU_STATS) "] Consulta le statistiche\n"
+					"[" TO_STRING(MENU_QUIT) "] Esci dal gioco");
 				option = get_int();
 			} while (option < MENU_QUIT || option > MENU_STATS);
 
 			switch (option) {
 				case MENU_NEWGAME: {
-					display_full_stats();
-					game_ctx = new_game();
+					display_stats_leaderboard();
+					game_ctx = new_game(options);
 					in_menu = false;
 					break;
 				}
 				case MENU_LOADSAVE: {
 					save_name = pick_save();
-					game_ctx = load_game(save_name);
+					game_ctx = load_game(save_name, options);
 					free_wrap(save_name);
 					if (game_ctx != NULL) // save was loaded correctly
 						in_menu = false;
@@ -56,7 +60,7 @@ game_contextT *main_menu(const char *provided_save) {
 			}
 		}
 	} else {
-		game_ctx = load_game(provided_save);
+		game_ctx = load_game(options->save_name, options);
 		if (game_ctx == NULL) {
 			puts("Impossibile caricare il salvataggio fornito da linea di comando!");
 			exit(EXIT_FAILURE);
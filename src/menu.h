@@ -3,6 +3,6 @@
 
 #include "types.h"
 
-game_contextT *main_menu(const char *provided_save);
+game_contextT *main_menu(const launch_optionsT *options);
 
 #endif // MENU_H
\ No newline at end of file
@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "replay.h"
+#include "structs.h"
+#include "input.h"
+#include "game.h"
+#include "gameplay.h"
+#include "saves.h"
+#include "stats.h"
+#include "utils.h"
+
+/**
+ * @brief starts recording the decisions of a new game, or attaches the replay being played by replay_game.
+ * seeds the libc random generator with the seed of the replay, so shuffles and random picks are reproduced.
+ * 
+ * @param game_ctx new game state
+ */
+void init_replay(game_contextT *game_ctx) {
+	if (active_replay == NULL) {
+		active_replay = (replayT*)calloc_checked(ONE_ELEMENT, sizeof(replayT));
+		active_replay->seed = (unsigned int)time(NULL);
+		active_replay->started = (long long)time(NULL);
+	}
+	game_ctx->replay = active_replay;
+	srand(active_replay->seed);
+}
+
+/**
+ * @brief opens the replay file of the recorded game next to its save, writing the header and the decisions recorded
+ * so far (such as the save name itself). does nothing when replaying.
+ * 
+ * @param game_ctx current game state
+ * @param save_name name of the save of the game
+ */
+void open_replay_file(game_contextT *game_ctx, const char *save_name) {
+	replayT *replay = game_ctx->replay;
+	replay_headerT header = { .magic = REPLAY_MAGIC, .version = REPLAY_VERSION };
+	char *replay_path;
+
+	if (replay == NULL || replay->playing)
+		return;
+
+	replay_path = get_replay_path(save_name);
+	replay->file = fopen(replay_path, "wb");
+	if (replay->file == NULL) {
+		fprintf(stderr, "Opening replay file (%s) failed!\n", replay_path);
+		exit(EXIT_FAILURE);
+	}
+	free_wrap(replay_path);
+
+	header.seed = replay->seed;
+	header.deck_hash = replay->deck_hash;
+	if (fwrite(&header, sizeof(replay_headerT), ONE_ELEMENT, replay->file) != ONE_ELEMENT
+		|| fwrite(replay->pending, 1, replay->n_pending, replay->file) != replay->n_pending) {
+		fputs("Writing replay file failed!\n", stderr);
+		exit(EXIT_FAILURE);
+	}
+	fflush(replay->file);
+
+	free_wrap(replay->pending);
+	replay->pending = NULL;
+	replay->n_pending = replay->pending_capacity = 0;
+}
+
+/**
+ * @brief records the deck the new game is played with, or checks that a replayed game is played with the recorded
+ * deck: a different deck (other --mazzo or --espansione options, or edited deck files) would silently diverge from
+ * the recording. does not return on a mismatch.
+ * 
+ * @param game_ctx new game state
+ * @param deck_hash hash of the merged deck table of the game
+ */
+void replay_deck(game_contextT *game_ctx, unsigned int deck_hash) {
+	replayT *replay = game_ctx->replay;
+
+	if (replay == NULL)
+		return;
+	if (!replay->playing)
+		replay->deck_hash = deck_hash;
+	else if (replay->deck_checked && replay->deck_hash != deck_hash) {
+		fprintf(stderr, "The replayed game was recorded with a different deck (%08x, now %08x)!\n"
+			"Usa le stesse opzioni --mazzo ed --espansione, e gli stessi file dei mazzi, della partita registrata.\n",
+			replay->deck_hash, deck_hash);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/**
+ * @brief checks if the game is being replayed: replays don't write saves nor stats
+ * 
+ * @param game_ctx current game state
+ * @return true if the game is being replayed
+ * @return false if the game is being played
+ */
+bool is_replaying(game_contextT *game_ctx) {
+	return game_ctx->replay != NULL && game_ctx->replay->playing;
+}
+
+/**
+ * @brief continues the hash of the game state with a list of cards, identified by their names
+ * 
+ * @param hash hash of the previous part of the state
+ * @param head head of the cards linked list
+ * @return unsigned int hash including the cards
+ */
+unsigned int hash_cards(unsigned int hash, cartaT *head) {
+	const unsigned char end_of_list = 0xFF; // never found in names, separates adjacent lists
+
+	for (; head != NULL; head = head->next)
+		hash = hash_update(hash, head->name, strlen(head->name)+1); // the terminator separates adjacent names
+	return hash_update(hash, &end_of_list, sizeof(end_of_list));
+}
+
+/**
+ * @brief hashes the state of the game: round, players (in turn order from the current one) with their cards, and
+ * every deck, cards order included
+ * 
+ * @param game_ctx current game state
+ * @return unsigned int hash of the state
+ */
+unsigned int hash_game_state(game_contextT *game_ctx) {
+	giocatoreT *player = game_ctx->curr_player;
+	unsigned int hash = hash_bytes(&game_ctx->round_num, sizeof(game_ctx->round_num));
+
+	hash = hash_update(hash, &game_ctx->n_players, sizeof(game_ctx->n_players));
+	for (int i = 0; i < game_ctx->n_players; i++, player = player->next) {
+		hash = hash_update(hash, player->name, strlen(player->name)+1);
+		hash = hash_cards(hash, player->carte);
+		hash = hash_cards(hash, player->aula);
+		hash = hash_cards(hash, player->bonus_malus);
+	}
+	hash = hash_cards(hash, game_ctx->mazzo_pesca);
+	hash = hash_cards(hash, game_ctx->mazzo_scarti);
+	return hash_cards(hash, game_ctx->aula_studio);
+}
+
+/**
+ * @brief closes the replay of a game. a recording is completed with a REPLAY_END record holding the final round, the
+ * state hash and the recording time, which replay_game checks.
+ * 
+ * @param game_ctx current game state
+ */
+void close_replay(game_contextT *game_ctx) {
+	replayT *replay = game_ctx->replay;
+
+	if (replay == NULL)
+		return;
+
+	if (!replay->playing && replay->file != NULL) {
+		write_replay_value(replay, REPLAY_END, game_ctx->round_num);
+		write_replay_varint(replay, hash_game_state(game_ctx));
+		write_replay_varint(replay, (unsigned long long)((long long)time(NULL) - replay->started));
+	}
+	if (replay->file != NULL && fclose(replay->file) != 0) {
+		fputs("Writing replay file failed!\n", stderr);
+		exit(EXIT_FAILURE);
+	}
+
+	if (active_replay == replay)
+		active_replay = NULL;
+	free_wrap(replay->pending);
+	free_wrap(replay);
+	game_ctx->replay = NULL;
+}
+
+/**
+ * @brief replays the recorded game of a save headlessly: the game is created with new_game and played feeding it
+ * the recorded decisions, then its final state is checked against the recorded one. the game output is discarded, only
+ * the outcome is shown (on standard error). saves, stats and logs are left untouched.
+ * 
+ * @param options command-line options: save whose game is replayed, base deck and expansion packs it was played with
+ * @return true if the replayed game matches the recording
+ * @return false if the final state differs
+ */
+bool replay_game(const launch_optionsT *options) {
+	launch_optionsT replay_options = *options;
+	replay_headerT header;
+	game_contextT *game_ctx;
+	unsigned long long recorded_hash, recorded_seconds;
+	long long recorded_round;
+	unsigned int n_decisions, hash;
+	double seconds;
+	bool matches;
+	clock_t start;
+	char *replay_path = get_replay_path(options->replay_name);
+	replayT *replay = (replayT*)calloc_checked(ONE_ELEMENT, sizeof(replayT));
+
+	// replays of version 1 end their header before the deck hash, so they are replayed without checking the deck
+	replay->file = fopen(replay_path, "rb");
+	if (replay->file == NULL || fread(&header, offsetof(replay_headerT, deck_hash), ONE_ELEMENT, replay->file) != ONE_ELEMENT
+		|| header.magic != REPLAY_MAGIC || (header.version != 1 && header.version != REPLAY_VERSION)
+		|| (header.version == REPLAY_VERSION
+			&& fread(&header.deck_hash, sizeof(header.deck_hash), ONE_ELEMENT, replay->file) != ONE_ELEMENT)) {
+		fprintf(stderr, "Reading replay file (%s) failed!\n", replay_path);
+		exit(EXIT_FAILURE);
+	}
+	free_wrap(replay_path);
+	replay->playing = true;
+	replay->seed = header.seed;
+	replay->deck_hash = header.deck_hash;
+	replay->deck_checked = header.version == REPLAY_VERSION;
+
+	if (freopen(NULL_DEVICE, "w", stdout) == NULL) {
+		fputs("Discarding standard output failed!\n", stderr);
+		exit(EXIT_FAILURE);
+	}
+	replay_options.log_level = LOG_LEVEL_OFF;
+	active_replay = replay;
+
+	start = clock();
+	game_ctx = new_game(&replay_options);
+	load_stats(game_ctx); // stats are updated in memory only
+	play_game(game_ctx);
+
+	recorded_round = read_replay_value(replay, REPLAY_END);
+	if (!read_replay_varint(replay, &recorded_hash) || !read_replay_varint(replay, &recorded_seconds)) {
+		fputs("Reading replay file failed!\n", stderr);
+		exit(EXIT_FAILURE);
+	}
+	hash = hash_game_state(game_ctx);
+	seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+	matches = hash == recorded_hash && game_ctx->round_num == recorded_round;
+	n_decisions = replay->n_decisions;
+
+	if (matches) {
+		fprintf(stderr, "Replay di \"%s\" riuscito: %u decisioni, %d round, stato finale identico (%08x).\n",
+			options->replay_name, n_decisions, game_ctx->round_num, hash);
+		fprintf(stderr, "Rigiocata in %.3f ms, registrata in %llu s", seconds * 1e3, recorded_seconds);
+		if (recorded_seconds != 0 && seconds > 0)
+			fprintf(stderr, " (%.0f volte piu' veloce)", recorded_seconds / seconds);
+		fputs(".\n", stderr);
+	} else
+		fprintf(stderr, "Replay di \"%s\" fallito: stato finale diverso (round %d, %08x) da quello registrato (round %lld, %08llx)!\n",
+			options->replay_name, game_ctx->round_num, hash, recorded_round, recorded_hash);
+
+	clear_game(game_ctx);
+	return matches;
+}
@@ -0,0 +1,15 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include "types.h"
+
+void init_replay(game_contextT *game_ctx);
+void open_replay_file(game_contextT *game_ctx, const char *save_name);
+void replay_deck(game_contextT *game_ctx, unsigned int deck_hash);
+bool is_replaying(game_contextT *game_ctx);
+unsigned int hash_game_state(game_contextT *game_ctx);
+void close_replay(game_contextT *game_ctx);
+bool replay_game(const launch_optionsT *options);
+
+#endif // REPLAY_H
\ No newline at end of file
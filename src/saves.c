@@ -1,11 +1,15 @@
 #define _GNU_SOURCE
 
 #include <string.h>
+#include <time.h>
 #include "saves.h"
 #include "constants.h"
 #include "utils.h"
+#include "input.h"
 #include "format.h"
 #include "files.h"
+#include "catalog.h"
+#include "structs.h"
 
 /**
  * @brief checks if given save name is valid
@@ -26,35 +30,20 @@ bool valid_save_name(const char *save_name) {
 }
 
 /**
- * @brief stores given save path's save to saves cache
+ * @brief registers an access to the given save path's save, appending a record to the saves catalog
  * 
- * @param save_path relative path of save to be cached
+ * @param save_path relative path of save to be registered
  */
-void cache_save_name(char *save_path) {
-	freeable_multiline_textT saves_cache;
+void register_save(const char *save_path) {
 	char *save_name;
-	bool already_cached = false;
-
-	init_multiline(&saves_cache);
-	load_saves_cache(&saves_cache);
 
 	save_name = strdup_checked(&save_path[strlen(SAVES_DIRECTORY)]); // skip SAVES_DIRECTORY substring
 	// make substring stripping save file extension
 	save_name[strnlen(save_name, SAVE_NAME_LEN + strlen(SAVE_PATH_EXTENSION)) - strlen(SAVE_PATH_EXTENSION)] = '\0';
 
-	// check if save name is already present in cache
-	for (int i = 0; i < saves_cache.n_lines && !already_cached; i++)
-		if (!strncmp(saves_cache.lines[i], save_name, SAVE_NAME_LEN))
-			already_cached = true;
-
-	// if not already present in cache, add it.
-	if (!already_cached) {
-		multiline_addline(&saves_cache, save_name);
-		save_saves_cache(&saves_cache);
-	} else
-		free_wrap(save_name);
+	append_saves_catalog(save_name, (long long)time(NULL));
 
-	clear_freeable_multiline(&saves_cache);
+	free_wrap(save_name);
 }
 
 /**
@@ -64,9 +53,17 @@ void cache_save_name(char *save_path) {
  * @return char* heap-allocated string containing relative path to the save relative to given save name
  */
 char *get_save_path(const char *save_name) {
-	char *save_path;
-	asprintf_s(&save_path, SAVES_DIRECTORY "%s" SAVE_PATH_EXTENSION, save_name);
-	return save_path;
+	return format_alloc(SAVES_DIRECTORY "%s" SAVE_PATH_EXTENSION, save_name);
+}
+
+/**
+ * @brief combines save name into relative path of the replay file recorded with the given save
+ * 
+ * @param save_name save name refering to a save in the saves directory
+ * @return char* heap-allocated string containing relative path to the replay file of the save
+ */
+char *get_replay_path(const char *save_name) {
+	return format_alloc(SAVES_DIRECTORY "%s" REPLAY_PATH_EXTENSION, save_name);
 }
 
 /**
@@ -83,29 +80,59 @@ char *ask_save_name(bool new) {
 			printf("Che nome vuoi dare al salvataggio? ");
 		else
 			printf("Inserisci il nome del salvataggio da caricare: ");
-	} while (scanf(" %" TO_STRING(SAVE_NAME_LEN) "[^\n]", save_name) != ONE_ELEMENT || !valid_save_name(save_name));
+	} while (!get_text(" %" TO_STRING(SAVE_NAME_LEN) "[^\n]", save_name, sizeof(save_name)) || !valid_save_name(save_name));
 
 	return strdup_checked(save_name);
 }
 
 /**
- * @brief prompts user to choice a saved game to load using saved games cache and manual prompt.
+ * @brief displays one entry of the saves list, with a summary of the save read from its metadata header
+ * 
+ * @param idx 1-indexed position of the save in the list
+ * @param save_name name of the save (without SAVE_PATH_EXTENSION)
+ */
+void show_save_summary(int idx, const char *save_name) {
+	save_headerT header;
+	char date[SAVE_DATE_LEN+1];
+	time_t timestamp;
+	char *save_path = get_save_path(save_name);
+
+	if (read_save_header(save_path, &header)) {
+		timestamp = (time_t)header.timestamp;
+		strftime(date, sizeof(date), SAVE_DATE_FORMAT, localtime(&timestamp));
+
+		printf(" [%d] " ANSI_BOLD "%s" ANSI_RESET " - %d giocatori (", idx, save_name, header.n_players);
+		for (int i = 0; i < header.n_players && i < MAX_PLAYERS; i++)
+			printf(i == 0 ? "%s" : ", %s", header.players[i]);
+		printf("), round %d, ultima modifica: %s", header.round_num, date);
+		if (header.winner[0] != '\0')
+			printf(", " ANSI_GREEN "vinta da %s" ANSI_RESET, header.winner);
+		puts("");
+	} else // missing save or legacy save without metadata header
+		printf(" [%d] " ANSI_BOLD "%s" ANSI_RESET " - nessuna informazione disponibile\n", idx, save_name);
+
+	free_wrap(save_path);
+}
+
+/**
+ * @brief prompts user to choice a saved game to load using the most recently used saves of the catalog and manual prompt.
  * 
  * @return char* the name of the chosen save to load (heap-allocated string)
  */
 char *pick_save(void) {
-	freeable_multiline_textT saves_cache;
-	int choice_idx;
+	saves_catalogT catalog;
+	int choice_idx, n_recent, recent[SAVES_MENU_COUNT];
 	char *save_name;
 	bool picked = false;
 
-	init_multiline(&saves_cache);
-	load_saves_cache(&saves_cache);
+	init_catalog(&catalog);
+	load_recent_saves(&catalog);
 
-	if (saves_cache.n_lines > 0) {
+	n_recent = catalog_most_recent(&catalog, recent, SAVES_MENU_COUNT);
+	if (n_recent > 0) {
 		puts("Ecco gli ultimi salvataggi:");
-		for (int i = 0; i < saves_cache.n_lines; i++)
-			printf(" [%d] %s\n", i+1, saves_cache.lines[i]);
+		for (int i = 0; i < n_recent; i++)
+			show_save_summary(i+1, catalog.entries[recent[i]].name);
 
 		puts("Se vuoi caricare un salvataggio non presente nella seguente lista spostalo nella cartella '" SAVES_DIRECTORY "'"
 			" e inseriscine il nome manualmente dopo aver selezionato 'no'. Sara' inserito nella lista per il futuro una volta caricato.");
@@ -114,14 +141,14 @@ char *pick_save(void) {
 			do {
 				puts("Scegli quale salvataggio vuoi caricare.");
 				choice_idx = get_int();
-			} while (choice_idx < 1 || choice_idx > saves_cache.n_lines);
-			save_name = strdup_checked(saves_cache.lines[choice_idx-1]);
+			} while (choice_idx < 1 || choice_idx > n_recent);
+			save_name = strdup_checked(catalog.entries[recent[choice_idx-1]].name);
 			picked = true;
 		}
 	}
 	if (!picked)
 		save_name = ask_save_name(false);
 
-	clear_freeable_multiline(&saves_cache);
+	clear_catalog(&catalog);
 	return save_name;
-}
\ No newline at end of file
+}
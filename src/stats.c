@@ -1,113 +1,292 @@
 #include <string.h>
+#include <time.h>
 #include "stats.h"
 #include "files.h"
 #include "utils.h"
 #include "card.h"
+#include "input.h"
 
 /**
- * @brief displays stats of all registered players showing maximums for wins, rounds, discarded and played aswell
+ * @brief returns the value of a metric of the stats of a player
  * 
+ * @param stats pointer to player stats
+ * @param metric stats metric
+ * @return int value of the metric
  */
-void display_full_stats(void) {
-	player_statsT stats, max_wins, max_rounds, max_discarded, max_played;
-	int count;
-	FILE *fp = open_stats_read();
-
-	for (count = 0; read_player_stats(fp, &stats); count++) {
-		if (count == 0)
-			max_wins = max_rounds = max_discarded = max_played = stats; // initialize maximums to first read stats
-
-		printf(ANSI_CYAN "\nStatistiche di " ANSI_BOLD ANSI_RED PRETTY_USERNAME ANSI_CYAN ":\n\n" ANSI_RESET, stats.name);
-
-		printf("  Totale partite vinte: " ANSI_BOLD "%d" ANSI_RESET "\n", stats.wins);
-		printf("  Totale round giocati: " ANSI_BOLD "%d" ANSI_RESET "\n", stats.rounds);
-		printf("  Carte scartate in totale: " ANSI_BOLD "%d" ANSI_RESET "\n", stats.rounds);
-		printf("  Carte giocate in totale: " ANSI_BOLD "%d" ANSI_RESET "\n\n", stats.played_cards[ALL]);
-
-		for (tipo_cartaT type = STUDENTE; type <= ISTANTANEA; type++) { // iterate over card type enum (ALL excluded)
-			printf("  Numero carte " COLORED_CARD_TYPE " giocate: " ANSI_BOLD "%d" ANSI_RESET "\n",
-				tipo_cartaT_color(type),
-				tipo_cartaT_str(type),
-				stats.played_cards[type]
+int stats_metric(player_statsT *stats, stats_metricT metric) {
+	switch (metric) {
+		case METRIC_WINS:
+			return stats->wins;
+		case METRIC_ROUNDS:
+			return stats->rounds;
+		case METRIC_DISCARDED:
+			return stats->discarded;
+		default:
+			return stats->played_cards[ALL];
+	}
+}
+
+/**
+ * @brief updates the top players of each metric in the stats summary after the stats of a player have been written.
+ * counters only grow, so a player can only climb the ranking: if a ranked player's value went down instead (e.g. two
+ * games of the same player saved their stats one after the other) someone else could now be above them, and the
+ * summary must be recomputed from all the records.
+ * 
+ * @param header pointer to the stats index header holding the summary
+ * @param record record number of the player stats
+ * @param stats written player stats
+ * @return true if the summary is up to date
+ * @return false if the summary must be recomputed
+ */
+bool update_stats_top(stats_index_headerT *header, int record, player_statsT *stats) {
+	int *records, *values, value, pos;
+	bool exact = true;
+
+	for (stats_metricT metric = METRIC_WINS; metric < METRICS_COUNT; metric++) {
+		records = header->top_records[metric];
+		values = header->top_values[metric];
+		value = stats_metric(stats, metric);
+
+		pos = 0;
+		while (pos < STATS_TOP_K && records[pos] != record+1)
+			pos++;
+		if (pos < STATS_TOP_K && value < values[pos])
+			exact = false;
+		else if (pos == STATS_TOP_K && (records[STATS_TOP_K-1] == 0 || value > values[STATS_TOP_K-1]))
+			pos = STATS_TOP_K-1; // enters the ranking in place of the last one
+
+		if (pos < STATS_TOP_K) {
+			records[pos] = record+1;
+			values[pos] = value;
+			for (; pos > 0 && (records[pos-1] == 0 || value > values[pos-1]); pos--) { // climb the ranking, ties keep their order
+				records[pos] = records[pos-1];
+				values[pos] = values[pos-1];
+				records[pos-1] = record+1;
+				values[pos-1] = value;
+			}
+		}
+	}
+	return exact;
+}
+
+/**
+ * @brief displays the players with the highest value of each metric, read from the stats summary: it takes the same
+ * time however many players are registered
+ * 
+ * @param store pointer to the stats store
+ */
+void display_leaderboard(stats_storeT *store) {
+	player_statsT stats;
+	int *records;
+
+	printf(ANSI_CYAN "\nClassifiche dei %d giocatori registrati:\n" ANSI_RESET, store->header.n_records);
+	for (stats_metricT metric = METRIC_WINS; metric < METRICS_COUNT; metric++) {
+		records = store->header.top_records[metric];
+		printf("\n  Piu' %s:\n", stats_metricT_str(metric));
+		for (int pos = 0; pos < STATS_TOP_K && records[pos] != 0; pos++) {
+			read_stats_record(store, records[pos]-1, &stats);
+			printf("    %d. " ANSI_BOLD ANSI_RED PRETTY_USERNAME ANSI_RESET " (%d %s)\n",
+				pos+1,
+				stats.name,
+				store->header.top_values[metric][pos],
+				stats_metricT_str(metric)
 			);
 		}
-		// keep track of maximums
-		if (stats.wins > max_wins.wins)
-			max_wins = stats;
-		if (stats.rounds > max_rounds.rounds)
-			max_rounds = stats;
-		if (stats.discarded > max_discarded.discarded)
-			max_discarded = stats;
-		if (stats.played_cards[ALL] > max_played.played_cards[ALL])
-			max_played = stats;
 	}
+	puts("");
+}
 
-	if (count != 0) {
-		printf("\nIl giocatore che ha vinto piu' partite di tutti e': " ANSI_BOLD ANSI_RED PRETTY_USERNAME " (%d partite vinte)!\n",
-			max_wins.name,
-			max_wins.wins
-		);
-		printf("Il giocatore che ha giocato piu' round di tutti e': " ANSI_BOLD ANSI_RED PRETTY_USERNAME " (%d round giocati in totale)!\n",
-			max_rounds.name,
-			max_rounds.rounds
-		);
-		printf("Il giocatore che ha scartato piu' carte di tutti e': " ANSI_BOLD ANSI_RED PRETTY_USERNAME " (%d carte scartate)!\n",
-			max_discarded.name,
-			max_discarded.discarded
-		);
-		printf("Il giocatore che ha giocato piu' carte di tutti e': " ANSI_BOLD ANSI_RED PRETTY_USERNAME " (%d carte giocate in tutto)!\n\n",
-			max_played.name,
-			max_played.played_cards[ALL]
+/**
+ * @brief displays the stats of a player
+ * 
+ * @param stats pointer to player stats
+ */
+void display_player_stats(player_statsT *stats) {
+	printf(ANSI_CYAN "\nStatistiche di " ANSI_BOLD ANSI_RED PRETTY_USERNAME ANSI_CYAN ":\n\n" ANSI_RESET, stats->name);
+
+	printf("  Totale partite vinte: " ANSI_BOLD "%d" ANSI_RESET "\n", stats->wins);
+	printf("  Totale round giocati: " ANSI_BOLD "%d" ANSI_RESET "\n", stats->rounds);
+	printf("  Carte scartate in totale: " ANSI_BOLD "%d" ANSI_RESET "\n", stats->discarded);
+	printf("  Carte giocate in totale: " ANSI_BOLD "%d" ANSI_RESET "\n\n", stats->played_cards[ALL]);
+
+	for (tipo_cartaT type = STUDENTE; type <= ISTANTANEA; type++) { // iterate over card type enum (ALL excluded)
+		printf("  Numero carte " COLORED_CARD_TYPE " giocate: " ANSI_BOLD "%d" ANSI_RESET "\n",
+			tipo_cartaT_color(type),
+			tipo_cartaT_str(type),
+			stats->played_cards[type]
 		);
-	} else {
+	}
+}
+
+/**
+ * @brief displays the leaderboards of the registered players, shown before starting a new game
+ * 
+ */
+void display_stats_leaderboard(void) {
+	stats_storeT store;
+
+	open_stats_store(&store, false);
+	if (store.header.n_records != 0)
+		display_leaderboard(&store);
+	close_stats_store(&store);
+}
+
+/**
+ * @brief displays the leaderboards of the registered players followed by the stats of each of them, STATS_PAGE_SIZE
+ * players per page (the user chooses whether to see the next page)
+ * 
+ */
+void display_full_stats(void) {
+	player_statsT stats;
+	stats_storeT store;
+	bool paging = true;
+
+	open_stats_store(&store, false);
+	if (store.header.n_records == 0) {
 		puts("Non sono presenti giocatori passati di cui visualizzare le statistiche.\n");
+		paging = false;
+	} else
+		display_leaderboard(&store);
+
+	for (int first = 0; paging; first += STATS_PAGE_SIZE) {
+		for (int record = first; record < first+STATS_PAGE_SIZE && record < store.header.n_records; record++) {
+			read_stats_record(&store, record, &stats);
+			display_player_stats(&stats);
+		}
+		paging = first+STATS_PAGE_SIZE < store.header.n_records;
+		if (paging) {
+			printf("\nGiocatori %d-%d di %d.\n[" TO_STRING(STATS_NEXT_PAGE) "] Pagina successiva\n[" TO_STRING(STATS_BACK) "] Torna al menu\n",
+				first+1, first+STATS_PAGE_SIZE, store.header.n_records);
+			lock_stats_store(&store, false); // never keep games from saving stats while waiting for the user
+			paging = get_int() == STATS_NEXT_PAGE;
+			lock_stats_store(&store, true);
+		}
 	}
+	puts("");
 
-	fclose(fp);
+	close_stats_store(&store);
 }
 
 /**
- * @brief loads statistics from stats file for the given player and returns new empty stats if player doesn't exist in stats file.
+ * @brief loads statistics from the stats store for the given player and returns new empty stats if player doesn't exist in stats file.
  * 
+ * @param store pointer to the stats store
  * @param player player to load stats for
  * @return player_statsT* player statistics loaded from file or newly created (empty)
  */
-player_statsT *load_player_stats(giocatoreT *player) {
+player_statsT *load_player_stats(stats_storeT *store, giocatoreT *player) {
 	player_statsT stats, *new_stats = calloc_checked(ONE_ELEMENT, sizeof(player_statsT));
-	bool found = false;
-	FILE *fp = open_stats_read();
+	int slot;
 
-	while (read_player_stats(fp, &stats) && !found) {
-		if (!strncmp(stats.name, player->name, GIOCATORE_NAME_LEN)) {
-			*new_stats = stats;
-			found = true;
-		}
-	}
-	if (!found)
+	if (find_player_stats(store, player->name, &stats, &slot) != -1)
+		*new_stats = stats;
+	else
 		strncpy(new_stats->name, player->name, sizeof(new_stats->name));
 
-	fclose(fp);
 	return new_stats;
 }
 
 /**
- * @brief load statistics for each player playing this game
+ * @brief returns the seat of the current player: seats are in turn order, starting from the player of the first round
+ * 
+ * @param game_ctx current game state
+ * @return int seat of the current player
+ */
+int curr_player_seat(game_contextT *game_ctx) {
+	return (game_ctx->round_num-1) % game_ctx->n_players;
+}
+
+/**
+ * @brief starts the record of the game in the history, once its stats are loaded: names of the players by seat and
+ * their lifetime played cards, from which the cards played during this game are computed when it's won
+ * 
+ * @param game_ctx current game state
+ */
+void begin_game_record(game_contextT *game_ctx) {
+	game_historyT *history = &game_ctx->history;
+	giocatoreT *player = game_ctx->curr_player;
+	player_statsT *stats = game_ctx->curr_stats;
+	int seat;
+
+	memset(history, 0, sizeof(game_historyT));
+	if (game_ctx->replay != NULL) // loaded games aren't recorded, see end_game_record
+		history->record.seed = game_ctx->replay->seed;
+	history->record.n_players = (unsigned char)game_ctx->n_players;
+	history->started = (long long)time(NULL);
+	for (int i = 0; i < game_ctx->n_players; i++, player = player->next, stats = stats->next) {
+		seat = (curr_player_seat(game_ctx) + i) % game_ctx->n_players;
+		memcpy(history->record.names[seat], player->name, sizeof(player->name));
+		memcpy(history->played_at_start[seat], stats->played_cards, sizeof(stats->played_cards));
+	}
+}
+
+/**
+ * @brief returns the seat of a player of the game
+ * 
+ * @param game_ctx current game state, whose record in the history was started
+ * @param name player name
+ * @return int seat of the player
+ */
+int player_seat(game_contextT *game_ctx, const char *name) {
+	int seat = 0;
+
+	while (strncmp(game_ctx->history.record.names[seat], name, GIOCATORE_NAME_LEN))
+		seat++;
+	return seat;
+}
+
+/**
+ * @brief load statistics for each player playing this game, opening the stats file only once
  * 
  * @param game_ctx current game state
  */
 void load_stats(game_contextT *game_ctx) {
 	giocatoreT *player;
 	player_statsT *curr_stats = NULL;
+	stats_storeT store;
+
+	open_stats_store(&store, false);
 
 	// game_ctx->curr_stats serves as the linked-list head
 	player = game_ctx->curr_player;
 	for (int i = 0; i < game_ctx->n_players; i++, player = player->next) {
 		if (game_ctx->curr_stats == NULL && curr_stats == NULL)
-			curr_stats = game_ctx->curr_stats = load_player_stats(player); // set linked list head
+			curr_stats = game_ctx->curr_stats = load_player_stats(&store, player); // set linked list head
 		else
-			curr_stats = curr_stats->next = load_player_stats(player);
+			curr_stats = curr_stats->next = load_player_stats(&store, player);
 	}
+	close_stats_store(&store);
 	curr_stats->next = game_ctx->curr_stats; // make the linked list circular linking tail to head
+
+	begin_game_record(game_ctx);
+	for (int i = 0; i < game_ctx->n_players; i++, curr_stats = curr_stats->next)
+		game_ctx->stored_stats[player_seat(game_ctx, curr_stats->name)] = *curr_stats;
+}
+
+/**
+ * @brief completes the record of the game in the history, once the current player won it. only games played from their
+ * creation in this session are recorded: the start time, seed and played cards of the sessions before a game was saved
+ * aren't kept by the save, so the record of a loaded game would only cover its last session
+ * 
+ * @param game_ctx current game state
+ */
+void end_game_record(game_contextT *game_ctx) {
+	game_historyT *history = &game_ctx->history;
+	player_statsT *stats = game_ctx->curr_stats;
+	int seat;
+
+	if (game_ctx->replay == NULL) // loaded from a save
+		return;
+
+	history->record.finished = (long long)time(NULL);
+	history->record.duration = (int)(history->record.finished - history->started);
+	history->record.rounds = (unsigned short)game_ctx->round_num;
+	history->record.winner = (unsigned char)curr_player_seat(game_ctx);
+	for (int i = 0; i < game_ctx->n_players; i++, stats = stats->next) {
+		seat = (curr_player_seat(game_ctx) + i) % game_ctx->n_players;
+		for (tipo_cartaT type = ALL; type <= ISTANTANEA; type++)
+			history->record.played_cards[seat][type] = (unsigned short)(stats->played_cards[type] - history->played_at_start[seat][type]);
+	}
 }
 
 /**
@@ -151,34 +330,65 @@ void stats_add_played_card(game_contextT *game_ctx, cartaT *card) {
 }
 
 /**
- * @brief updates stats for a player in the stats file
+ * @brief adds the counters of some stats to the counters of other stats
  * 
- * @param stats_update updated player stats
+ * @param stats stats to update
+ * @param added stats to add
  */
-void update_stats(player_statsT *stats_update) {
-	player_statsT stats;
-	bool found = false;
-	FILE *fp = open_stats_read_write();
+void add_player_stats(player_statsT *stats, const player_statsT *added) {
+	stats->wins += added->wins;
+	stats->rounds += added->rounds;
+	stats->discarded += added->discarded;
+	for (tipo_cartaT type = ALL; type <= ISTANTANEA; type++)
+		stats->played_cards[type] += added->played_cards[type];
+}
 
-	while (!found && read_player_stats(fp, &stats)) {
-		if (!strncmp(stats.name, stats_update->name, GIOCATORE_NAME_LEN)) {
-			fseek(fp, -(long)sizeof(player_statsT), SEEK_CUR); // move cursor back to the start of the just read stats, to overwrite them
-			found = true;
-		}
-	}
-	// write stats update, overwriting same player's stats if found, appending new stats if not found
-	write_player_stats(fp, stats_update); 
+/**
+ * @brief brings the stats of a player up to date with the stats file, which other games of the same player running at
+ * the same time may have updated since this game last read or wrote them: only the changes made by this game are kept
+ * on top of the stats in the file (cards played in the other games don't count as played during this game, either)
+ * 
+ * @param game_ctx current game state
+ * @param seat seat of the player
+ * @param stats stats of the player in this game
+ * @param file_stats stats of the player in the stats file
+ */
+void merge_stored_stats(game_contextT *game_ctx, int seat, player_statsT *stats, const player_statsT *file_stats) {
+	player_statsT *stored = &game_ctx->stored_stats[seat];
 
-	fclose(fp);
+	stats->wins += file_stats->wins - stored->wins;
+	stats->rounds += file_stats->rounds - stored->rounds;
+	stats->discarded += file_stats->discarded - stored->discarded;
+	for (tipo_cartaT type = ALL; type <= ISTANTANEA; type++) {
+		stats->played_cards[type] += file_stats->played_cards[type] - stored->played_cards[type];
+		game_ctx->history.played_at_start[seat][type] += file_stats->played_cards[type] - stored->played_cards[type];
+	}
 }
 
 /**
- * @brief updates stats for each player in the game to the stats file
+ * @brief updates stats for each player in the game to the stats file, opening it only once, and appends the record of
+ * the game to the history if it was won. the stats file is locked while the stats are merged and written, so games
+ * running at the same time update it one after the other
  * 
  * @param game_ctx current game state
  */
 void save_stats(game_contextT *game_ctx) {
-	player_statsT *curr_stats = game_ctx->curr_stats;
-	for (int i = 0; i < game_ctx->n_players; i++, curr_stats = curr_stats->next)
-		update_stats(curr_stats);
+	player_statsT *curr_stats = game_ctx->curr_stats, file_stats;
+	stats_storeT store;
+	int seat, record, slot;
+
+	open_stats_store(&store, true);
+	for (int i = 0; i < game_ctx->n_players; i++, curr_stats = curr_stats->next) {
+		seat = player_seat(game_ctx, curr_stats->name);
+		record = find_player_stats(&store, curr_stats->name, &file_stats, &slot);
+		if (record == -1)
+			memset(&file_stats, 0, sizeof(player_statsT)); // new player
+		merge_stored_stats(game_ctx, seat, curr_stats, &file_stats);
+		put_player_stats(&store, curr_stats, record, slot); // the player is looked up only once
+		game_ctx->stored_stats[seat] = *curr_stats;
+	}
+	close_stats_store(&store);
+
+	if (game_ctx->history.record.finished != 0)
+		append_game_record(&game_ctx->history.record);
 }
\ No newline at end of file
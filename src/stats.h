@@ -1,12 +1,17 @@
 #ifndef STATS_H
 #define STATS_H
 
+#include <stdbool.h>
 #include "types.h"
 
+void display_stats_leaderboard(void);
 void display_full_stats(void);
+bool update_stats_top(stats_index_headerT *header, int record, player_statsT *stats);
 void load_stats(game_contextT *game_ctx);
 void save_stats(game_contextT *game_ctx);
+void add_player_stats(player_statsT *stats, const player_statsT *added);
 
+void end_game_record(game_contextT *game_ctx);
 void stats_add_win(game_contextT *game_ctx);
 void stats_add_round(game_contextT *game_ctx);
 void stats_add_discarded(game_contextT *game_ctx);
@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <pthread.h>
 #include "constants.h"
 #include "types.h"
 #include "enums.h"
@@ -34,32 +35,309 @@ struct Effetto {
 };
 // end basic game structs
 
+struct PlayerStats {
+	char name[GIOCATORE_NAME_LEN+1];
+	int wins, rounds, discarded;
+	int played_cards[CARDS_TYPE_COUNT];
+	player_statsT *next;
+};
+
+struct GameRecord {
+	long long finished; // timestamp of the end of the game
+	unsigned int seed; // seed of the libc random generator of the game (see replay.c)
+	int duration; // seconds from the start of the game to its end
+	unsigned short rounds;
+	unsigned char n_players;
+	unsigned char winner; // seat of the winner, seats are in turn order starting from the player of the first round
+	char names[MAX_PLAYERS][GIOCATORE_NAME_LEN+1];
+	unsigned short played_cards[MAX_PLAYERS][CARDS_TYPE_COUNT]; // cards played by each seat from the creation of the game to its end, by type (ALL included)
+};
+
+struct HistoryHeader {
+	unsigned int magic;
+	int version;
+	int record_size; // detect layout changes of the game records
+};
+
+struct HistoryTotals {
+	long long games, invalid, rounds, duration;
+	long long games_by_players[MAX_PLAYERS+1]; // by number of players
+	long long wins_by_seat[MAX_PLAYERS+1][MAX_PLAYERS]; // by number of players and seat of the winner
+	long long played_winners[CARDS_TYPE_COUNT], played_others[CARDS_TYPE_COUNT]; // by card type, summed over the games
+	long long games_by_month[HISTORY_MONTHS], rounds_by_month[HISTORY_MONTHS];
+};
+
+struct HistoryQuery {
+	const char *path;
+	long first, count; // range of game records scanned by the thread
+	pthread_t thread;
+	history_totalsT totals; // partial totals of the range, merged once every thread is done
+};
+
+struct StatsMergeTable {
+	player_statsT *entries; // stats of each player summed over the shards
+	bool *merged; // entries already folded into a record of the stats file
+	int *slots; // entry+1 for each slot, 0 if empty (open addressing by player name, kept at most half full)
+	int n_entries, capacity, n_slots;
+};
+
+struct ExportBuffer {
+	FILE *out;
+	size_t len;
+	char data[EXPORT_BUFFER_SIZE];
+};
+
+struct GameHistory {
+	game_recordT record; // completed once the game is won (unless it was loaded from a save), then appended to FILE_HISTORY by save_stats
+	int played_at_start[MAX_PLAYERS][CARDS_TYPE_COUNT]; // lifetime played cards of each seat when stats were loaded
+	long long started; // timestamp of the start of the game (or of its loading, for loaded games which aren't recorded)
+};
+
 struct GameContext {
 	giocatoreT *curr_player;
 	cartaT *mazzo_pesca, *mazzo_scarti, *aula_studio;
 	int n_players, round_num;
 	bool game_running;
-	FILE *log_file;
+	loggerT *logger; // NULL if logging is off
+	log_levelT log_level; // minimum level of the events written to logs
+	int log_categories; // mask of the log categories written to logs
 	char *save_path;
 	player_statsT *curr_stats;
+	checkpoint_ringT *checkpoints;
+	bool rolled_back;
+	replayT *replay; // recorder or player of the game decisions, NULL if the game was loaded
+	game_historyT history;
+	player_statsT stored_stats[MAX_PLAYERS]; // stats of each seat as last read from or written to the stats file
+};
+
+struct LogRecord {
+	unsigned char type; // log_event_typeT
+	unsigned char actor, target; // seats of the players (LOG_NO_SEAT if none)
+	unsigned char card_type; // tipo_cartaT
+	unsigned char effect, effect_players; // azioneT and target_giocatoriT of the effect
+	unsigned short round_num;
+	unsigned int card, other_card; // card ids (hash of the card name, 0 if none), or values described by the event type
+};
+
+struct Logger {
+	unsigned int head; // next record to push, written only by the game thread
+	log_recordT records[LOG_RING_SIZE]; // also keeps head and tail on different cache lines
+	unsigned int tail; // next record to write, written only by the writer thread
+	bool running; // cleared by the game thread to stop the writer once the ring is drained
+	FILE *file;
+	pthread_t writer;
+	int n_seats;
+	giocatoreT *seats[MAX_PLAYERS]; // players declared by log_players, in seat order
+	unsigned int known_cards[LOG_KNOWN_CARDS]; // open addressing set of card ids already declared in this session (0 if empty)
+	const char *logged_save_path; // save path declared in this session
+	char *compress_path; // rotated log file compressed by the compressor thread, NULL if none
+	pthread_t compressor; // only started when there is a rotated log file to compress
+};
+
+struct LogCard {
+	unsigned int id;
+	tipo_cartaT tipo;
+	quandoT quando;
+	char *name;
+};
+
+struct LogPrinter {
+	char *players[MAX_PLAYERS]; // names of the players by seat, declared by LOG_EV_PLAYER records
+	int n_cards, cards_capacity;
+	log_cardT *cards; // cards declared by LOG_EV_CARD records
+	char *save_path; // declared by LOG_EV_SAVE_PATH records
+};
+
+struct ReplayHeader {
+	unsigned int magic;
+	int version;
+	unsigned int seed; // seed of the libc random generator for the whole game
+	unsigned int deck_hash; // hash of the merged deck table the game is played with (since version 2)
+};
+
+struct Replay {
+	bool playing; // decisions are read from file (replay command) instead of asked and recorded
+	FILE *file; // NULL while recording until the save name is known
+	unsigned char *pending; // records written before the file was opened
+	size_t n_pending, pending_capacity;
+	unsigned int seed;
+	unsigned int deck_hash; // hash of the merged deck table, see hash_deck_table
+	bool deck_checked; // false when replaying a recording of version 1, which doesn't identify its deck
+	unsigned int n_decisions;
+	long long started; // timestamp of the start of the recording
 };
 
 struct MultiLineText {
-	int n_lines;
+	int n_lines, capacity;
 	const char **lines;
 	int *lengths;
 };
 
+struct ScratchBlock {
+	scratch_blockT *prev; // older block of the scratch arena, NULL for the first one
+	size_t used, capacity;
+	char data[]; // capacity bytes
+};
+
+struct ScratchMark {
+	scratch_blockT *block; // newest block when the mark was taken, NULL if the arena was empty
+	size_t used;
+};
+
+struct CardRender {
+	unsigned int hash; // hash of the card name, 0 marks an empty slot
+	char name[CARTA_NAME_LEN+1];
+	multiline_textT box; // lines of the card box, pointing into text
+	const char *compact; // single line of the compact view, pointing into text
+	int compact_len; // visual length of the compact line
+	char *text; // every line of the box and the compact line, in a single allocation
+};
+
+struct CardRenderCache {
+	int n_renders, n_slots; // n_slots is a power of 2
+	card_renderT *slots;
+};
+
+struct Frame {
+	char *buf; // screen being composed
+	size_t used, capacity;
+	int depth; // nesting of frame_begin calls, the screen is written when it goes back to 0
+	bool screen; // the frame shows cards, in TUI mode it's drawn at the top of the terminal
+};
+
+struct TuiScreen {
+	bool active;
+	int rows; // terminal rows when the screen was last drawn, 0 if what the terminal shows is unknown
+	int n_lines, lines_capacity; // lines of the frame drawn at the top of the terminal
+	size_t *starts, *next_starts; // offsets of the lines into the drawn (and next) frame, plus the end of the last line
+	unsigned int *hashes, *next_hashes; // hashes of the lines of the drawn (and next) frame
+	int *shown; // line of the drawn frame shown by each row after scrolling it, -1 if unknown
+	char *text; // copy of the drawn frame
+	size_t text_capacity;
+	char *out; // cursor movements and changed lines written by a draw
+	size_t out_used, out_capacity;
+};
+
+struct TerminalSize {
+	int rows, columns;
+};
+
+struct TextSpan {
+	short offset, length; // into the wrapped string
+};
+
 struct WrappedText {
-	char *text;
-	multiline_textT multiline;
+	int n_lines;
+	text_spanT lines[WRAP_MAX_LINES];
 };
 
-struct PlayerStats {
-	char name[GIOCATORE_NAME_LEN+1];
-	int wins, rounds, discarded;
-	int played_cards[CARDS_TYPE_COUNT];
-	player_statsT *next;
+struct DeckOverride {
+	char name[CARTA_NAME_LEN+1]; // overridden definition, possibly of another pack
+	int amount; // new copies of the definition in the deck (0 removes it)
+};
+
+struct DeckTable {
+	int n_definitions, definitions_capacity;
+	cartaT *definitions; // one card per distinct card of the deck, effetti point into the effects pool
+	int *amounts; // copies of each definition in the deck
+	int *packs; // pack defining each definition, index into pack_names (only assigned when merging packs)
+	int n_effects, effects_capacity;
+	effettoT *effects; // effects of every definition, in definitions order
+	int n_overrides, overrides_capacity;
+	deck_overrideT *overrides; // copy-count overrides declared by a single pack, applied when merging it
+	int *name_slots, n_name_slots; // name index: definition index+1 per slot (0 if empty), open addressing on hash_string
+	int n_packs;
+	char pack_names[MAX_DECK_PACKS][DECK_PACK_NAME_LEN+1]; // names of the merged packs, in loading order
+	int n_cards; // total cards in the deck (sum of amounts)
+};
+
+struct DeckTokenizer {
+	const char *source_name; // shown in parse errors
+	const char *text;
+	size_t length, pos;
+	int line, column;
+};
+
+struct DeckCacheHeader {
+	unsigned int magic;
+	int version;
+	int card_size, effect_size; // detect layout changes of the dumped structs
+	long long source_size, source_mtime;
+	unsigned int source_hash;
+	int n_definitions, n_effects, n_overrides, n_cards;
+};
+
+struct SaveHeader {
+	unsigned int magic;
+	int version;
+	int n_players, round_num;
+	long long timestamp;
+	char players[MAX_PLAYERS][GIOCATORE_NAME_LEN+1];
+	char winner[GIOCATORE_NAME_LEN+1]; // empty string while the game is still running
+};
+
+struct LaunchOptions {
+	const char *save_name; // save to load directly, NULL to show the main menu
+	const char *deck_path; // custom base deck file for new games, NULL to use the default deck
+	int n_expansions;
+	const char *expansion_paths[MAX_DECK_PACKS-1]; // expansion packs added to the base deck, in loading order
+	log_levelT log_level;
+	int log_categories;
+	long long log_max_size; // log file size (bytes) rotating it when a session starts, 0 to never rotate
+	int log_segments; // rotated log files kept
+	bool log_compress; // compress the rotated log files
+	const char *replay_name; // save whose recorded game is replayed headlessly, NULL to play
+	bool tui; // draw screens on the alternate screen, redrawing only changed lines
+	bool compact; // start with the compact view of the cards
+};
+
+struct SaveEntry {
+	char *name;
+	long long last_access;
+	int prev, next; // MRU list links (indexes into the entries array, -1 if none)
+};
+
+struct SavesCatalog {
+	int n_entries, entries_capacity;
+	save_entryT *entries;
+	int n_slots; // hash index size, always a power of 2
+	int *slots; // open addressing hash index of entries by name (-1 if slot is empty)
+	int mru_head, mru_tail; // most and least recently used entries
+};
+
+struct StatsIndexHeader {
+	unsigned int magic;
+	int version;
+	int record_size; // detect layout changes of the stats records
+	int n_records; // records of the stats file, the index is rebuilt if the file has a different amount
+	int n_slots; // power of 2, followed by the slots: record number+1 of each player (0 if the slot is empty)
+	int top_records[METRICS_COUNT][STATS_TOP_K]; // record number+1 of the players with the highest value of each metric, highest first (0 if empty)
+	int top_values[METRICS_COUNT][STATS_TOP_K];
+};
+
+struct StatsStore {
+	FILE *records; // stats file
+	FILE *index; // hash index of the records by player name, NULL if it can't be written (records are scanned instead)
+	stats_index_headerT header;
+	bool write; // opened to update the stats, holding the exclusive lock of the stats file instead of a shared one
+};
+
+struct Checkpoint {
+	int round_num;
+	int curr_seat; // seat of the player playing the round
+	unsigned short zone_lengths[CHECKPOINT_ZONES];
+	unsigned short *cards; // indexes into the ring cards table, zone after zone
+	player_statsT stats[MAX_PLAYERS]; // stats of each seat (only counters are restored)
+};
+
+struct CheckpointRing {
+	int n_seats;
+	giocatoreT *seats[MAX_PLAYERS]; // players in turn order (player links never change during a game)
+	player_statsT *seat_stats[MAX_PLAYERS];
+	int n_cards;
+	cartaT **cards; // every card of the game sorted by address, cards are only moved between zones during a game
+	int head, count; // newest checkpoint and number of stored checkpoints
+	checkpointT checkpoints[CHECKPOINT_RING_SIZE];
 };
 
 #endif // STRUCTS_H
\ No newline at end of file
@@ -0,0 +1,328 @@
+#define _XOPEN_SOURCE 700 // fileno, sigaction with SA_RESTART
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/ioctl.h>
+#endif
+#include "tui.h"
+#include "frame.h"
+#include "format.h"
+#include "utils.h"
+
+tui_screenT tui = { 0 }; // model of what the terminal shows in TUI mode
+
+terminal_sizeT terminal_size = { 0 }; // size of the terminal read by the last query, 0 rows before the first one
+volatile sig_atomic_t terminal_resized = 0; // set by SIGWINCH, the next query reads the size again
+
+/**
+ * @brief SIGWINCH handler: the terminal was resized, its size is read again by the next query
+ * 
+ * @param sig received signal
+ */
+void terminal_resized_handler(int sig) {
+	(void)sig;
+	terminal_resized = 1;
+}
+
+/**
+ * @brief returns the size of the terminal, asking it when possible. the size is read once and cached until the terminal
+ * is resized (SIGWINCH, whose handler is installed by the first query), where there is no such signal it's read at
+ * every query. what can't be asked is read from LINES and COLUMNS, or assumed (TUI_DEFAULT_ROWS and
+ * TERMINAL_DEFAULT_COLUMNS, the width of CARDS_PER_ROW cards).
+ * 
+ * @return terminal_sizeT terminal rows and columns
+ */
+terminal_sizeT get_terminal_size(void) {
+	const char *lines, *columns;
+#ifdef _WIN32
+	CONSOLE_SCREEN_BUFFER_INFO info;
+#else
+	struct winsize size;
+#endif
+#ifdef SIGWINCH
+	struct sigaction action;
+
+	if (terminal_size.rows > 0 && !terminal_resized)
+		return terminal_size; // unchanged since the last query
+	if (terminal_size.rows == 0) { // first query
+		memset(&action, 0, sizeof(action));
+		action.sa_handler = terminal_resized_handler;
+		action.sa_flags = SA_RESTART; // reads of the user input go on after a resize
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGWINCH, &action, NULL);
+	}
+	terminal_resized = 0;
+#endif
+
+	lines = getenv("LINES");
+	columns = getenv("COLUMNS");
+	terminal_size.rows = lines != NULL && atoi(lines) > 0 ? atoi(lines) : TUI_DEFAULT_ROWS;
+	terminal_size.columns = columns != NULL && atoi(columns) > 0 ? atoi(columns) : TERMINAL_DEFAULT_COLUMNS;
+#ifdef _WIN32
+	if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+		terminal_size.rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+		terminal_size.columns = info.srWindow.Right - info.srWindow.Left + 1;
+	}
+#else
+	if (ioctl(fileno(stdout), TIOCGWINSZ, &size) == 0) {
+		if (size.ws_row > 0)
+			terminal_size.rows = size.ws_row;
+		if (size.ws_col > 0)
+			terminal_size.columns = size.ws_col;
+	}
+#endif
+	return terminal_size;
+}
+
+/**
+ * @brief appends bytes to the output of the current draw
+ * 
+ * @param str bytes to append
+ * @param len number of bytes
+ */
+void tui_append(const char *str, size_t len) {
+	if (tui.out_used + len > tui.out_capacity) {
+		tui.out_capacity = tui.out_capacity == 0 ? FRAME_MIN_CAPACITY : tui.out_capacity;
+		while (tui.out_used + len > tui.out_capacity)
+			tui.out_capacity *= 2;
+		tui.out = (char*)realloc_checked(tui.out, tui.out_capacity);
+	}
+	memcpy(tui.out + tui.out_used, str, len);
+	tui.out_used += len;
+}
+
+/**
+ * @brief appends a formatted escape sequence with one or two rows/columns to the output of the current draw
+ * 
+ * @param format escape sequence format, with as many %d as given values
+ * @param first first value
+ * @param second second value (ignored by formats with a single %d)
+ */
+void tui_append_escape(const char *format, int first, int second) {
+	char escape[FORMAT_LINE_LEN];
+	tui_append(escape, format_buf(escape, sizeof(escape), format, first, second));
+}
+
+/**
+ * @brief restores the terminal as it was before start_tui, whatever the state of the program (it only writes)
+ * 
+ */
+void tui_restore_terminal(void) {
+	const char restore[] = ANSI_RESET_SCROLL_REGION ANSI_ALT_SCREEN_OFF;
+	write_stdout(restore, sizeof(restore)-1);
+}
+
+/**
+ * @brief SIGINT handler: leaves the alternate screen before terminating like the default handler
+ * 
+ * @param sig received signal
+ */
+void tui_interrupted(int sig) {
+	tui_restore_terminal();
+	signal(sig, SIG_DFL);
+	raise(sig);
+}
+
+/**
+ * @brief switches the terminal to the alternate screen: from now on every screen composed by frame.c is drawn at its
+ * top, with prompts and messages scrolling below it. the terminal is restored at exit.
+ * 
+ */
+void start_tui(void) {
+	const char enter[] = ANSI_ALT_SCREEN_ON ANSI_CLEAR_SCREEN;
+
+	write_stdout(enter, sizeof(enter)-1);
+	tui.active = true;
+	tui.rows = tui.n_lines = 0; // nothing drawn yet
+	atexit(stop_tui);
+	signal(SIGINT, tui_interrupted);
+}
+
+/**
+ * @brief goes back to the normal screen (what was shown on the alternate one is lost), does nothing if not in TUI mode
+ * 
+ */
+void stop_tui(void) {
+	if (!tui.active)
+		return;
+	tui_restore_terminal();
+	signal(SIGINT, SIG_DFL);
+	tui.active = false;
+	free_wrap(tui.starts);
+	free_wrap(tui.next_starts);
+	free_wrap(tui.hashes);
+	free_wrap(tui.next_hashes);
+	free_wrap(tui.shown);
+	free_wrap(tui.text);
+	free_wrap(tui.out);
+	tui.lines_capacity = 0;
+	tui.text_capacity = tui.out_capacity = tui.out_used = 0;
+}
+
+/**
+ * @brief splits a composed screen into lines, into next_starts and next_hashes
+ * 
+ * @param buf composed screen
+ * @param size size of the composed screen
+ * @return int number of lines
+ */
+int tui_split_lines(const char *buf, size_t size) {
+	int n_lines = 0;
+
+	for (size_t i = 0; i <= size; i++) {
+		if (i == size && (size == 0 || buf[size-1] == '\n')) // the screen ends with a complete line
+			break;
+		if (n_lines+2 > tui.lines_capacity) { // room for the line and the end of the last one
+			tui.lines_capacity = tui.lines_capacity == 0 ? MULTILINE_MIN_CAPACITY : tui.lines_capacity*2;
+			tui.starts = (size_t*)realloc_checked(tui.starts, tui.lines_capacity*sizeof(size_t));
+			tui.next_starts = (size_t*)realloc_checked(tui.next_starts, tui.lines_capacity*sizeof(size_t));
+			tui.hashes = (unsigned int*)realloc_checked(tui.hashes, tui.lines_capacity*sizeof(unsigned int));
+			tui.next_hashes = (unsigned int*)realloc_checked(tui.next_hashes, tui.lines_capacity*sizeof(unsigned int));
+			tui.shown = (int*)realloc_checked(tui.shown, tui.lines_capacity*sizeof(int));
+		}
+		tui.next_starts[n_lines] = i;
+		while (i < size && buf[i] != '\n')
+			i++;
+		tui.next_hashes[n_lines] = hash_update(HASH_INIT, buf + tui.next_starts[n_lines], i - tui.next_starts[n_lines]);
+		tui.next_starts[++n_lines] = i+1; // the newline is skipped
+	}
+	return n_lines;
+}
+
+/**
+ * @brief checks whether a line of the drawn screen is the same as a line of the next one
+ * 
+ * @param old line of the drawn screen
+ * @param line line of the next screen
+ * @param buf next screen
+ * @return true if the lines are equal
+ */
+bool tui_same_line(int old, int line, const char *buf) {
+	size_t len = tui.next_starts[line+1]-1 - tui.next_starts[line];
+	return tui.hashes[old] == tui.next_hashes[line] && tui.starts[old+1]-1 - tui.starts[old] == len
+		&& memcmp(tui.text + tui.starts[old], buf + tui.next_starts[line], len) == 0;
+}
+
+/**
+ * @brief finds how many rows the drawn screen should be scrolled by to show the most lines of the next one where they
+ * already are (e.g. the same cards group drawn a few rows above or below), like curses does
+ * 
+ * @param buf next screen
+ * @param n_lines lines of the next screen
+ * @return int rows to scroll the drawn screen up by (down if negative)
+ */
+int tui_best_shift(const char *buf, int n_lines) {
+	int best_shift = 0, best_matches = -1, matches;
+
+	for (int shift = 1-n_lines; shift < tui.n_lines; shift++) {
+		matches = 0;
+		for (int i = MAX(0, -shift); i < n_lines && i+shift < tui.n_lines; i++)
+			matches += tui_same_line(i+shift, i, buf);
+		if (matches > best_matches || (matches == best_matches && abs(shift) < abs(best_shift))) {
+			best_matches = matches;
+			best_shift = shift;
+		}
+	}
+	return best_shift;
+}
+
+/**
+ * @brief appends a changed line of the next screen to the output of the current draw. if the row shows a line of the
+ * drawn screen, only what follows the last ANSI_RESET of their common start is written (the terminal is then in its
+ * default state, like at the start of the line).
+ * 
+ * @param row row (0-based)
+ * @param old line of the drawn screen shown by the row, -1 if unknown
+ * @param buf next screen
+ */
+void tui_draw_line(int row, int old, const char *buf) {
+	const char *line = buf + tui.next_starts[row], *old_line;
+	size_t len = tui.next_starts[row+1]-1 - tui.next_starts[row], common = 0, from = 0, reset_len = strlen(ANSI_RESET);
+
+	if (old != -1) {
+		old_line = tui.text + tui.starts[old];
+		while (common < len && common < tui.starts[old+1]-1 - tui.starts[old] && line[common] == old_line[common])
+			common++;
+		for (size_t i = 0; i+reset_len <= common; i++) {
+			if (!memcmp(line + i, ANSI_RESET, reset_len))
+				from = i+reset_len;
+		}
+	}
+	tui_append_escape(ANSI_CURSOR_FORMAT, row+1, text_width(line, from)+1);
+	tui_append(line + from, len - from);
+	tui_append(ANSI_CLEAR_LINE, strlen(ANSI_CLEAR_LINE));
+}
+
+/**
+ * @brief draws a composed screen at the top of the terminal, writing only what differs from the screen drawn before:
+ * the drawn screen is first scrolled if that brings more of its lines where the new one has them, then changed lines are
+ * written from where they start to differ and the rows the new screen doesn't cover anymore are cleared. the rows below
+ * it are then made to scroll on their own, with the cursor on the last one, so prompts and messages never move the
+ * screen. a screen too tall to leave TUI_MIN_MESSAGE_ROWS rows below it is written like in normal mode instead.
+ * 
+ * @param buf composed screen
+ * @param size size of the composed screen
+ */
+void draw_tui_screen(const char *buf, size_t size) {
+	int rows = get_terminal_size().rows, n_lines = tui_split_lines(buf, size), shift, region;
+	size_t *starts;
+	unsigned int *hashes;
+
+	tui.out_used = 0;
+	if (rows != tui.rows) { // first draw or resized terminal: what it shows is unknown
+		tui_append(ANSI_RESET_SCROLL_REGION ANSI_CLEAR_SCREEN, strlen(ANSI_RESET_SCROLL_REGION ANSI_CLEAR_SCREEN));
+		tui.n_lines = 0;
+	}
+
+	if (n_lines > rows - TUI_MIN_MESSAGE_ROWS) { // scroll it from the last row, forgetting the screen
+		tui_append(ANSI_RESET_SCROLL_REGION, strlen(ANSI_RESET_SCROLL_REGION));
+		tui_append_escape(ANSI_CURSOR_FORMAT, rows, 1);
+		tui_append("\n", 1);
+		tui_append(buf, size);
+		write_stdout(tui.out, tui.out_used);
+		tui.rows = tui.n_lines = 0;
+		return;
+	}
+
+	shift = tui_best_shift(buf, n_lines);
+	region = MAX(tui.n_lines, n_lines); // rows of both screens
+	if (shift != 0) {
+		tui_append_escape(ANSI_SCROLL_REGION_FORMAT, 1, region);
+		tui_append_escape(shift > 0 ? ANSI_SCROLL_UP_FORMAT : ANSI_SCROLL_DOWN_FORMAT, abs(shift), 0);
+	}
+	for (int i = 0; i < region; i++)
+		tui.shown[i] = i+shift >= 0 && i+shift < tui.n_lines ? i+shift : -1;
+
+	tui_append(ANSI_RESET_SCROLL_REGION, strlen(ANSI_RESET_SCROLL_REGION)); // cursor addressing over the whole terminal
+	for (int i = 0; i < n_lines; i++) {
+		if (tui.shown[i] == -1 || !tui_same_line(tui.shown[i], i, buf))
+			tui_draw_line(i, tui.shown[i], buf);
+	}
+	for (int i = n_lines; i < tui.n_lines; i++) { // the previous screen was taller
+		tui_append_escape(ANSI_CURSOR_FORMAT, i+1, 1);
+		tui_append(ANSI_CLEAR_LINE, strlen(ANSI_CLEAR_LINE));
+	}
+	tui_append_escape(ANSI_SCROLL_REGION_FORMAT, n_lines+1, rows);
+	tui_append_escape(ANSI_CURSOR_FORMAT, rows, 1);
+	write_stdout(tui.out, tui.out_used);
+
+	// the drawn screen becomes the model
+	if (size > tui.text_capacity) {
+		tui.text_capacity = size;
+		tui.text = (char*)realloc_checked(tui.text, tui.text_capacity);
+	}
+	if (size > 0)
+		memcpy(tui.text, buf, size);
+	starts = tui.starts;
+	tui.starts = tui.next_starts;
+	tui.next_starts = starts;
+	hashes = tui.hashes;
+	tui.hashes = tui.next_hashes;
+	tui.next_hashes = hashes;
+	tui.n_lines = n_lines;
+	tui.rows = rows;
+}
@@ -0,0 +1,15 @@
+#ifndef TUI_H
+#define TUI_H
+
+#include <stddef.h>
+#include "types.h"
+#include "structs.h"
+
+extern tui_screenT tui;
+
+terminal_sizeT get_terminal_size(void);
+void start_tui(void);
+void stop_tui(void);
+void draw_tui_screen(const char *buf, size_t size);
+
+#endif // TUI_H
\ No newline at end of file
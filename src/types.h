@@ -10,12 +10,50 @@ typedef enum TipoCarta tipo_cartaT;
 typedef enum Quando quandoT;
 typedef enum Azione azioneT;
 typedef enum TargetGiocatori target_giocatoriT;
+typedef enum LogEventType log_event_typeT;
+typedef enum LogLevel log_levelT;
+typedef enum ReplayKind replay_kindT;
+typedef enum StatsMetric stats_metricT;
+typedef enum FileLock file_lockT;
 // end base types
 
 typedef struct GameContext game_contextT;
 typedef struct MultiLineText multiline_textT;
 typedef multiline_textT freeable_multiline_textT;
+typedef struct TextSpan text_spanT;
 typedef struct WrappedText wrapped_textT;
+typedef struct ScratchBlock scratch_blockT;
+typedef struct ScratchMark scratch_markT;
 typedef struct PlayerStats player_statsT;
+typedef struct StatsIndexHeader stats_index_headerT;
+typedef struct StatsStore stats_storeT;
+typedef struct GameRecord game_recordT;
+typedef struct HistoryHeader history_headerT;
+typedef struct GameHistory game_historyT;
+typedef struct HistoryTotals history_totalsT;
+typedef struct HistoryQuery history_queryT;
+typedef struct ExportBuffer export_bufferT;
+typedef struct StatsMergeTable stats_merge_tableT;
+typedef struct SaveHeader save_headerT;
+typedef struct DeckTable deck_tableT;
+typedef struct DeckOverride deck_overrideT;
+typedef struct DeckCacheHeader deck_cache_headerT;
+typedef struct DeckTokenizer deck_tokenizerT;
+typedef struct SaveEntry save_entryT;
+typedef struct SavesCatalog saves_catalogT;
+typedef struct Checkpoint checkpointT;
+typedef struct CheckpointRing checkpoint_ringT;
+typedef struct LaunchOptions launch_optionsT;
+typedef struct LogRecord log_recordT;
+typedef struct Logger loggerT;
+typedef struct LogCard log_cardT;
+typedef struct LogPrinter log_printerT;
+typedef struct ReplayHeader replay_headerT;
+typedef struct Replay replayT;
+typedef struct CardRender card_renderT;
+typedef struct CardRenderCache card_render_cacheT;
+typedef struct Frame frameT;
+typedef struct TuiScreen tui_screenT;
+typedef struct TerminalSize terminal_sizeT;
 
 #endif // TYPES_H
\ No newline at end of file
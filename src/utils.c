@@ -7,32 +7,6 @@
 #include "debugging.h"
 #endif
 
-/**
- * @brief prompts user to insert an integer from standard input, doesn't return until an integer is supplied
- * 
- * @return int inserted integer
- */
-int get_int(void) {
-	printf("> ");
-	int val;
-	while (scanf(" %d", &val) != ONE_ELEMENT)
-		getchar();
-	return val;
-}
-
-/**
- * @brief prompts user to make a yes or no choice
- * 
- * @return true if user chose yes
- * @return false if user chose no
- */
-bool ask_choice(void) {
-	char choice = 'n';
-	printf("(" ANSI_GREEN "y" ANSI_RESET "/" ANSI_RED "N" ANSI_RESET "): ");
-	scanf(" %c", &choice);
-	return choice == 'y' || choice == 'Y';
-}
-
 /**
  * @brief wrap around malloc() function, shows debug trace if compiled with -DDEBUG
  * 
@@ -112,6 +86,51 @@ int rand_int(int min, int max) {
 	return rand() % (max-min+1) + min;
 }
 
+/**
+ * @brief computes the 32-bit FNV-1a hash of a string
+ * 
+ * @param str string to hash
+ * @return unsigned int hash of the string
+ */
+unsigned int hash_string(const char *str) {
+	unsigned int hash = HASH_INIT;
+
+	for (; *str != '\0'; str++) {
+		hash ^= (unsigned char)*str;
+		hash *= 16777619u; // FNV prime
+	}
+	return hash;
+}
+
+/**
+ * @brief computes the 32-bit FNV-1a hash of a memory block
+ * 
+ * @param data pointer to the memory block
+ * @param size size of the memory block in bytes
+ * @return unsigned int hash of the memory block
+ */
+unsigned int hash_bytes(const void *data, size_t size) {
+	return hash_update(HASH_INIT, data, size);
+}
+
+/**
+ * @brief continues a 32-bit FNV-1a hash with a memory block, to hash data spread over several blocks
+ * 
+ * @param hash hash of the previous blocks (HASH_INIT for the first block)
+ * @param data pointer to the memory block
+ * @param size size of the memory block in bytes
+ * @return unsigned int hash of the previous blocks followed by the memory block
+ */
+unsigned int hash_update(unsigned int hash, const void *data, size_t size) {
+	const unsigned char *bytes = data;
+
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 16777619u; // FNV prime
+	}
+	return hash;
+}
+
 /**
  * @brief mimics functionality of strdup() function.
  * allocates a heap block to store a copy fo the provided string and returns a pointer to it.
@@ -9,8 +9,9 @@
 #define TO_STRING(x) STRINGIFY(x)
 
 #define MIN(a, b) (a < b ? a : b)
+#define MAX(a, b) (a > b ? a : b)
 
-int get_int(void);
+#define HASH_INIT 2166136261u // FNV offset basis
 
 void *malloc_checked(size_t size);
 void *calloc_checked(size_t nmemb, size_t size);
@@ -21,6 +22,8 @@ char *strdup_checked(const char *str);
 
 int rand_int(int min, int max);
 
-bool ask_choice(void);
+unsigned int hash_string(const char *str);
+unsigned int hash_bytes(const void *data, size_t size);
+unsigned int hash_update(unsigned int hash, const void *data, size_t size);
 
 #endif // UTILS_H
\ No newline at end of file
@@ -0,0 +1,110 @@
+#define _POSIX_C_SOURCE 200809L // clock_gettime
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "structs.h"
+#include "gameplay.h"
+#include "logging.h"
+#include "utils.h"
+
+/**
+ * @brief returns a monotonic timestamp
+ * 
+ * @return double seconds from an arbitrary point
+ */
+double bench_now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief creates a game with BENCH_PLAYERS players and no cards, without asking anything
+ * 
+ * @return game_contextT* newly created game context
+ */
+game_contextT *new_bench_game(void) {
+	game_contextT *game_ctx = (game_contextT*)calloc_checked(ONE_ELEMENT, sizeof(game_contextT));
+	giocatoreT *player = NULL;
+
+	game_ctx->n_players = BENCH_PLAYERS;
+	for (int i = 0; i < game_ctx->n_players; i++) {
+		if (player == NULL)
+			player = game_ctx->curr_player = (giocatoreT*)calloc_checked(ONE_ELEMENT, sizeof(giocatoreT));
+		else
+			player = player->next = (giocatoreT*)calloc_checked(ONE_ELEMENT, sizeof(giocatoreT));
+		snprintf(player->name, sizeof(player->name), "Giocatore %d", i+1);
+	}
+	player->next = game_ctx->curr_player;
+	game_ctx->round_num = 1;
+
+	return game_ctx;
+}
+
+/**
+ * @brief times the placement path of play_card (play event, join_aula and leave_aula of a card without effects) with
+ * the given log settings
+ * 
+ * @param game_ctx bench game
+ * @param card card to place
+ * @param options log level and categories
+ * @return double nanoseconds per placement
+ */
+double bench_placements(game_contextT *game_ctx, cartaT *card, const launch_optionsT *options) {
+	giocatoreT *thrower = game_ctx->curr_player, *target = thrower->next;
+	double start, elapsed;
+
+	init_logging(game_ctx, options);
+	log_players(game_ctx);
+
+	start = bench_now();
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		LOG_EVENT(game_ctx, LOG_LEVEL_DETAIL, LOG_CAT_CARDS, LOG_EV_PLAY_ON, thrower, target, card, NULL, card->tipo, NULL);
+		join_aula(game_ctx, target, card);
+		leave_aula(game_ctx, target, card, !DISPATCH_EFFECTS);
+	}
+	elapsed = bench_now() - start;
+
+	shutdown_logging(game_ctx); // includes writing the pending records, not timed
+	return elapsed * 1e9 / BENCH_ITERATIONS;
+}
+
+/**
+ * @brief bench entry point: compares the cost of placing a card with logging off, masked by level or category and on.
+ * run it from a scratch directory, as it writes (and then removes) FILE_LOG.
+ * 
+ * @return int exit code
+ */
+int main(void) {
+	const struct {
+		const char *name;
+		log_levelT level;
+		int categories;
+	} modes[] = {
+		{ "off (" OPTION_LOG_LEVEL " nessuno)", LOG_LEVEL_OFF, LOG_CAT_ALL },
+		{ "level masked (" OPTION_LOG_LEVEL " turno)", LOG_LEVEL_ROUND, LOG_CAT_ALL },
+		{ "category masked (" OPTION_LOG_CATEGORIES " effetti)", LOG_LEVEL_DETAIL, LOG_CAT_EFFECTS },
+		{ "on (" OPTION_LOG_LEVEL " dettaglio)", LOG_LEVEL_DETAIL, LOG_CAT_ALL }
+	};
+	launch_optionsT options = { 0 };
+	cartaT card = { .name = "Bonus di prova", .tipo = BONUS, .quando = MAI };
+	game_contextT *game_ctx = new_bench_game();
+
+	printf("LOG_COMPILE_LEVEL %d, %d placements per mode\n", LOG_COMPILE_LEVEL, BENCH_ITERATIONS);
+	for (int i = 0; i < (int)(sizeof(modes)/sizeof(modes[0])); i++) {
+		options.log_level = modes[i].level;
+		options.log_categories = modes[i].categories;
+		bench_placements(game_ctx, &card, &options); // warm up
+		printf("%-40s %8.2f ns/placement\n", modes[i].name, bench_placements(game_ctx, &card, &options));
+	}
+	remove(FILE_LOG);
+
+	for (int i = 0; i < BENCH_PLAYERS; i++) {
+		giocatoreT *next = game_ctx->curr_player->next;
+		free_wrap(game_ctx->curr_player);
+		game_ctx->curr_player = next;
+	}
+	free_wrap(game_ctx);
+	return EXIT_SUCCESS;
+}
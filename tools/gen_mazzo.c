@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "structs.h"
+#include "deck.h"
+#include "utils.h"
+
+/**
+ * @brief call this when writing the generated source fails
+ * 
+ */
+void generation_failed(void) {
+	fputs("Error occurred while writing the generated source!\n", stderr);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief writes a string as a C string literal, escaping everything that isn't printable ASCII
+ * 
+ * @param out generated source stream
+ * @param str string to write
+ */
+void write_string_literal(FILE *out, const char *str) {
+	fputc('"', out);
+	for (; *str != '\0'; str++) {
+		if (*str == '"' || *str == '\\' || *str == '?') // '?' is escaped to never form trigraphs
+			fprintf(out, "\\%c", *str);
+		else if (*str >= ' ' && *str <= '~')
+			fputc(*str, out);
+		else
+			fprintf(out, "\\%03o", (unsigned char)*str); // always 3 octal digits, so a following digit is never consumed
+	}
+	fputc('"', out);
+}
+
+/**
+ * @brief writes the deck table as const C arrays plus the EMBEDDED_DECK table referencing them (a single pack: packs and
+ * the name index are assigned when it is merged)
+ * 
+ * @param out generated source stream
+ * @param deck pointer to the parsed deck table
+ * @param source_name name of the deck file, mentioned in the generated source
+ */
+void write_deck_source(FILE *out, deck_tableT *deck, const char *source_name) {
+	int effect_idx = 0;
+
+	fprintf(out, "// generated by tools/gen_mazzo.c from %s, do not edit\n\n", source_name);
+	fputs("#include \"structs.h\"\n#include \"deck.h\"\n\n", out);
+
+	// packed effects pool, an array can't be empty so a deck without effects gets a placeholder
+	fputs("static const effettoT embedded_effects[] = {\n", out);
+	for (int i = 0; i < deck->n_effects; i++)
+		fprintf(out, "\t{ %d, %d, %d },\n", deck->effects[i].azione, deck->effects[i].target_giocatori, deck->effects[i].target_carta);
+	if (deck->n_effects == 0)
+		fputs("\t{ 0, 0, 0 },\n", out);
+	fputs("};\n\n", out);
+
+	fputs("static const cartaT embedded_definitions[] = {\n", out);
+	for (int i = 0; i < deck->n_definitions; i++) {
+		cartaT *card = &deck->definitions[i];
+		fputs("\t{\n\t\t.name = ", out);
+		write_string_literal(out, card->name);
+		fputs(",\n\t\t.description = ", out);
+		write_string_literal(out, card->description);
+		fprintf(out, ",\n\t\t.tipo = %d,\n\t\t.n_effetti = %d,\n", card->tipo, card->n_effetti);
+		if (card->n_effetti != 0)
+			fprintf(out, "\t\t.effetti = (effettoT*)&embedded_effects[%d],\n", effect_idx);
+		else
+			fputs("\t\t.effetti = NULL,\n", out);
+		fprintf(out, "\t\t.quando = %d,\n\t\t.opzionale = %s,\n\t\t.next = NULL\n\t},\n", card->quando, card->opzionale ? "true" : "false");
+		effect_idx += card->n_effetti;
+	}
+	if (deck->n_definitions == 0)
+		fputs("\t{ .name = \"\" },\n", out);
+	fputs("};\n\n", out);
+
+	fputs("static const int embedded_amounts[] = {", out);
+	for (int i = 0; i < deck->n_definitions; i++)
+		fprintf(out, i == 0 ? " %d" : ", %d", deck->amounts[i]);
+	fputs(deck->n_definitions == 0 ? " 0 };\n\n" : " };\n\n", out);
+
+	if (deck->n_overrides != 0) {
+		fputs("static const deck_overrideT embedded_overrides[] = {\n", out);
+		for (int i = 0; i < deck->n_overrides; i++) {
+			fputs("\t{ ", out);
+			write_string_literal(out, deck->overrides[i].name);
+			fprintf(out, ", %d },\n", deck->overrides[i].amount);
+		}
+		fputs("};\n\n", out);
+	}
+
+	// capacities equal sizes: the table is never grown nor freed
+	fprintf(out, "const deck_tableT EMBEDDED_DECK = {\n"
+		"\t.n_definitions = %d,\n\t.definitions_capacity = %d,\n"
+		"\t.definitions = (cartaT*)embedded_definitions,\n\t.amounts = (int*)embedded_amounts,\n"
+		"\t.n_effects = %d,\n\t.effects_capacity = %d,\n\t.effects = (effettoT*)embedded_effects,\n"
+		"\t.n_overrides = %d,\n\t.overrides_capacity = %d,\n\t.overrides = %s,\n"
+		"\t.n_cards = %d\n};\n",
+		deck->n_definitions, deck->n_definitions, deck->n_effects, deck->n_effects, deck->n_overrides, deck->n_overrides,
+		deck->n_overrides != 0 ? "(deck_overrideT*)embedded_overrides" : "NULL", deck->n_cards);
+}
+
+/**
+ * @brief generator entry point: compiles a deck file into a C source defining EMBEDDED_DECK
+ * 
+ * @param argc command line arguments count
+ * @param argv deck file path and generated source path
+ * @return int exit code
+ */
+int main(int argc, const char *argv[]) {
+	deck_tableT deck;
+	char *text;
+	long length;
+	FILE *fp, *out;
+
+	if (argc != 3) {
+		fprintf(stderr, "Usage: %s <deck file> <generated source>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	fp = fopen(argv[1], "rb"); // binary mode, line endings are handled by the tokenizer
+	if (fp == NULL || fseek(fp, 0, SEEK_END) != 0 || (length = ftell(fp)) < 0) {
+		fprintf(stderr, "Opening cards file (%s) failed!\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+	rewind(fp);
+	text = (char*)malloc_checked(length+1);
+	if (fread(text, 1, length, fp) != (size_t)length) {
+		fprintf(stderr, "Reading cards file (%s) failed!\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+	fclose(fp);
+
+	init_deck_table(&deck);
+	parse_deck(&deck, text, length, argv[1]);
+	free_wrap(text);
+
+	out = fopen(argv[2], "w");
+	if (out == NULL) {
+		fprintf(stderr, "Opening generated source (%s) failed!\n", argv[2]);
+		return EXIT_FAILURE;
+	}
+	write_deck_source(out, &deck, argv[1]);
+	if (ferror(out) || fclose(out) != 0) {
+		remove(argv[2]); // never leave a truncated source behind
+		generation_failed();
+	}
+
+	clear_deck_table(&deck);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,273 @@
+#define _POSIX_C_SOURCE 200809L // sysconf
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "structs.h"
+#include "enums.h"
+#include "utils.h"
+
+/**
+ * @brief prints that the history file is invalid, then terminates
+ * 
+ * @param path history file path
+ */
+void history_file_invalid(const char *path) {
+	fprintf(stderr, "History file (%s) is invalid!\n", path);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief returns the month of a timestamp as months from january of HISTORY_FIRST_YEAR, converting days to a civil date
+ * without gmtime (which isn't thread-safe). algorithm from https://howardhinnant.github.io/date_algorithms.html
+ * 
+ * @param timestamp seconds from the epoch
+ * @return int month, -1 if it's out of the counted months
+ */
+int history_month(long long timestamp) {
+	long long days = (timestamp >= 0 ? timestamp : timestamp - 86399) / 86400 + 719468; // days from 0000-03-01
+	long long era = (days >= 0 ? days : days - 146096) / 146097;
+	long long day_of_era = days - era * 146097;
+	long long year_of_era = (day_of_era - day_of_era/1460 + day_of_era/36524 - day_of_era/146096) / 365;
+	long long day_of_year = day_of_era - (365*year_of_era + year_of_era/4 - year_of_era/100);
+	long long month = (5*day_of_year + 2) / 153; // 0 is march
+	long long year = year_of_era + era * 400 + (month >= 10); // january and february belong to the next year
+	long long months = (year - HISTORY_FIRST_YEAR) * 12 + (month < 10 ? month + 2 : month - 10);
+
+	return months >= 0 && months < HISTORY_MONTHS ? (int)months : -1;
+}
+
+/**
+ * @brief adds a game record to the totals, counting it as invalid if its players or winner are out of range
+ * 
+ * @param totals totals to update
+ * @param record game record
+ */
+void add_game_record(history_totalsT *totals, const game_recordT *record) {
+	int month;
+
+	if (record->n_players < 1 || record->n_players > MAX_PLAYERS || record->winner >= record->n_players) {
+		totals->invalid++;
+		return;
+	}
+
+	totals->games++;
+	totals->rounds += record->rounds;
+	totals->duration += record->duration;
+	totals->games_by_players[record->n_players]++;
+	totals->wins_by_seat[record->n_players][record->winner]++;
+	for (int seat = 0; seat < record->n_players; seat++) {
+		for (int type = 0; type < CARDS_TYPE_COUNT; type++) {
+			if (seat == record->winner)
+				totals->played_winners[type] += record->played_cards[seat][type];
+			else
+				totals->played_others[type] += record->played_cards[seat][type];
+		}
+	}
+	month = history_month(record->finished);
+	if (month != -1) {
+		totals->games_by_month[month]++;
+		totals->rounds_by_month[month] += record->rounds;
+	}
+}
+
+/**
+ * @brief thread scanning a range of game records: it reads them in batches of HISTORY_QUERY_BATCH through its own
+ * unbuffered stream (batches are already large reads) and only updates its own totals, so threads never synchronize
+ * 
+ * @param arg pointer to the history_queryT of the thread
+ * @return void* NULL
+ */
+void *history_query_thread(void *arg) {
+	history_queryT *query = (history_queryT*)arg;
+	game_recordT *batch = (game_recordT*)malloc_checked(HISTORY_QUERY_BATCH * sizeof(game_recordT));
+	FILE *fp = fopen(query->path, "rb");
+	size_t n_read;
+
+	if (fp == NULL || setvbuf(fp, NULL, _IONBF, 0) != 0 ||
+		fseek(fp, sizeof(history_headerT) + query->first * (long)sizeof(game_recordT), SEEK_SET) != 0)
+		history_file_invalid(query->path);
+	for (long left = query->count; left > 0; left -= (long)n_read) {
+		n_read = fread(batch, sizeof(game_recordT), left < HISTORY_QUERY_BATCH ? (size_t)left : HISTORY_QUERY_BATCH, fp);
+		if (n_read == 0)
+			history_file_invalid(query->path); // the file was truncated while scanning it
+		for (size_t i = 0; i < n_read; i++)
+			add_game_record(&query->totals, &batch[i]);
+	}
+
+	fclose(fp);
+	free_wrap(batch);
+	return NULL;
+}
+
+/**
+ * @brief adds the partial totals of a thread to the overall ones
+ * 
+ * @param totals overall totals
+ * @param partial totals of a thread
+ */
+void merge_history_totals(history_totalsT *totals, const history_totalsT *partial) {
+	totals->games += partial->games;
+	totals->invalid += partial->invalid;
+	totals->rounds += partial->rounds;
+	totals->duration += partial->duration;
+	for (int n = 0; n <= MAX_PLAYERS; n++) {
+		totals->games_by_players[n] += partial->games_by_players[n];
+		for (int seat = 0; seat < MAX_PLAYERS; seat++)
+			totals->wins_by_seat[n][seat] += partial->wins_by_seat[n][seat];
+	}
+	for (int type = 0; type < CARDS_TYPE_COUNT; type++) {
+		totals->played_winners[type] += partial->played_winners[type];
+		totals->played_others[type] += partial->played_others[type];
+	}
+	for (int month = 0; month < HISTORY_MONTHS; month++) {
+		totals->games_by_month[month] += partial->games_by_month[month];
+		totals->rounds_by_month[month] += partial->rounds_by_month[month];
+	}
+}
+
+/**
+ * @brief scans a history file splitting its records among threads, then merges their totals
+ * 
+ * @param path history file path
+ * @param n_threads maximum amount of threads
+ * @param totals overall totals (out parameter)
+ */
+void query_history(const char *path, int n_threads, history_totalsT *totals) {
+	history_headerT header;
+	history_queryT *queries;
+	long size, n_records;
+	FILE *fp = fopen(path, "rb");
+
+	if (fp == NULL) {
+		fprintf(stderr, "Opening history file (%s) failed!\n", path);
+		exit(EXIT_FAILURE);
+	}
+	if (fread(&header, sizeof(history_headerT), ONE_ELEMENT, fp) != ONE_ELEMENT || header.magic != HISTORY_MAGIC ||
+		header.version != HISTORY_VERSION || header.record_size != (int)sizeof(game_recordT) ||
+		fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0)
+		history_file_invalid(path);
+	fclose(fp);
+
+	// records appended after this point (by a game finishing now) are left out, and a partially written one is ignored
+	n_records = (size - (long)sizeof(history_headerT)) / (long)sizeof(game_recordT);
+	if (n_records < (long)n_threads * HISTORY_QUERY_BATCH)
+		n_threads = (int)(n_records / HISTORY_QUERY_BATCH) + 1; // a thread for each batch at most
+	queries = (history_queryT*)calloc_checked(n_threads, sizeof(history_queryT));
+	for (int i = 0; i < n_threads; i++) {
+		queries[i].path = path;
+		queries[i].first = n_records * i / n_threads;
+		queries[i].count = n_records * (i+1) / n_threads - queries[i].first;
+		if (pthread_create(&queries[i].thread, NULL, history_query_thread, &queries[i]) != 0) {
+			fprintf(stderr, "Creating history query thread failed!\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	memset(totals, 0, sizeof(history_totalsT));
+	for (int i = 0; i < n_threads; i++) {
+		pthread_join(queries[i].thread, NULL);
+		merge_history_totals(totals, &queries[i].totals);
+	}
+	free_wrap(queries);
+}
+
+/**
+ * @brief returns a percentage, 0 if the total is 0
+ * 
+ * @param part part of the total
+ * @param total total
+ * @return double percentage
+ */
+double percentage(long long part, long long total) {
+	return total > 0 ? 100.0 * part / total : 0;
+}
+
+/**
+ * @brief returns an average, 0 if there are no elements
+ * 
+ * @param sum sum of the elements
+ * @param count amount of elements
+ * @return double average
+ */
+double average(long long sum, long long count) {
+	return count > 0 ? (double)sum / count : 0;
+}
+
+/**
+ * @brief prints the aggregated history
+ * 
+ * @param totals overall totals
+ */
+void print_history_totals(const history_totalsT *totals) {
+	long long others = 0;
+
+	printf("Partite registrate: %lld", totals->games);
+	if (totals->invalid > 0)
+		printf(" (%lld record non validi ignorati)", totals->invalid);
+	printf("\nRound per partita in media: %.1f\nDurata media di una partita: %.1f minuti\n",
+		average(totals->rounds, totals->games), average(totals->duration, totals->games) / 60);
+
+	puts("\nPartite e vittorie per posto, per numero di giocatori:");
+	for (int n = 1; n <= MAX_PLAYERS; n++) {
+		if (totals->games_by_players[n] > 0) {
+			printf("  %d giocatori: %lld partite (%.1f%%), vittorie", n, totals->games_by_players[n],
+				percentage(totals->games_by_players[n], totals->games));
+			for (int seat = 0; seat < n; seat++)
+				printf(" posto %d %.1f%%", seat+1, percentage(totals->wins_by_seat[n][seat], totals->games_by_players[n]));
+			putchar('\n');
+		}
+	}
+
+	for (int n = 1; n <= MAX_PLAYERS; n++)
+		others += totals->games_by_players[n] * (n-1); // players who didn't win, summed over the games
+	puts("\nCarte giocate in media per partita, vincitore / altri giocatori:");
+	for (int type = 0; type < CARDS_TYPE_COUNT; type++)
+		printf("  %s: %.2f / %.2f\n", type == ALL ? "Totale" : tipo_cartaT_str((tipo_cartaT)type),
+			average(totals->played_winners[type], totals->games), average(totals->played_others[type], others));
+
+	puts("\nPartite per mese:");
+	for (int month = 0; month < HISTORY_MONTHS; month++) {
+		if (totals->games_by_month[month] > 0)
+			printf("  %04d-%02d: %lld partite, %.1f round in media\n", HISTORY_FIRST_YEAR + month/12, month%12 + 1,
+				totals->games_by_month[month], average(totals->rounds_by_month[month], totals->games_by_month[month]));
+	}
+}
+
+/**
+ * @brief returns the amount of query threads: one for each online processor
+ * 
+ * @return int amount of threads
+ */
+int default_history_threads(void) {
+	long n_threads = HISTORY_QUERY_DEFAULT_THREADS;
+#ifdef _SC_NPROCESSORS_ONLN
+	n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n_threads < 1)
+		n_threads = HISTORY_QUERY_DEFAULT_THREADS;
+#endif
+	return n_threads < HISTORY_QUERY_MAX_THREADS ? (int)n_threads : HISTORY_QUERY_MAX_THREADS;
+}
+
+/**
+ * @brief aggregates the history of the finished games: history_query [history file] [threads]
+ * 
+ * @param argc arguments count
+ * @param argv arguments
+ * @return int exit status
+ */
+int main(int argc, const char *argv[]) {
+	const char *path = argc > 1 ? argv[1] : FILE_HISTORY;
+	int n_threads = argc > 2 ? atoi(argv[2]) : default_history_threads();
+	history_totalsT *totals = (history_totalsT*)malloc_checked(sizeof(history_totalsT));
+
+	if (n_threads < 1 || n_threads > HISTORY_QUERY_MAX_THREADS) {
+		fprintf(stderr, "Threads must be between 1 and %d!\n", HISTORY_QUERY_MAX_THREADS);
+		return EXIT_FAILURE;
+	}
+
+	query_history(path, n_threads, totals);
+	print_history_totals(totals);
+	free_wrap(totals);
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,309 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "structs.h"
+#include "enums.h"
+#include "utils.h"
+
+/**
+ * @brief returns the text template of an event type. placeholders: {A} actor, {T} target, {C} card, {D} other card,
+ * {K} card type, {E} effect, {F} full effect, {Q} quando and {Y} tipo of the card, {N} number, {S} save path
+ * 
+ * @param type event type
+ * @return const char* template or NULL for dictionary records and unknown types
+ */
+const char *log_template(log_event_typeT type) {
+	static const char *mapping[] = {
+		[LOG_EV_START] = "Avvio del logging...",
+		[LOG_EV_STOP] = "Arresto del logging...",
+		[LOG_EV_NEW_GAME] = "Creazione nuova partita...",
+		[LOG_EV_LOAD_GAME] = "Caricamento partita da '{S}'...",
+		[LOG_EV_DECK_LOADED] = "Caricate {N} carte nel mazzo!",
+		[LOG_EV_CLOSE] = "Chiusura del gioco...",
+		[LOG_EV_SAVE] = "Salvataggio su '{S}' in corso...",
+		[LOG_EV_ROLLBACK] = "Partita riportata all'inizio del round tramite checkpoint.",
+		[LOG_EV_DRAW] = "{A} ha pescato '{C}'.",
+		[LOG_EV_DISCARD] = "{A} ha scartato '{C}'.",
+		[LOG_EV_DISCARD_NONE] = "{A} avrebbe dovuto scartare una carta {K}, ma non ne aveva.",
+		[LOG_EV_NO_PLAYABLE] = "{A} avrebbe dovuto giocare una carta {K} ma non ne aveva di giocabili.",
+		[LOG_EV_PLAY_PREVENTED] = "{A} ha provato a giocare '{C}' ma ha l'effetto {E} attivo su carte {Y}.",
+		[LOG_EV_PLAY] = "{A} gioca '{C}'.",
+		[LOG_EV_PLAY_ON] = "{A} gioca '{C}' su {T}.",
+		[LOG_EV_PLAY_DUPLICATE] = "{A} ha provato a giocare '{C}' su {T} (duplicato), scartandola.",
+		[LOG_EV_DEFEND_PLACEMENT] = "{T} si difende dal piazzamento di '{C}' nei {Y} da parte di {A} usando '{D}'.",
+		[LOG_EV_DEFEND_EFFECT] = "{T} si difende dall'attacco {F} di '{C}' da parte di {A} usando '{D}'.",
+		[LOG_EV_JOIN_AULA] = "Una carta {Y} entra nell'aula di {T}: '{C}'.",
+		[LOG_EV_LEAVE_AULA] = "Una carta {Y} lascia l'aula di {T}: '{C}'.",
+		[LOG_EV_APPLY_EFFECTS] = "Applicazione degli effetti di '{C}' ({Q}) di {A}.",
+		[LOG_EV_CHAIN_BLOCKED] = "La catena degli effetti di '{C}' giocata da {A} e' stata interrotta.",
+		[LOG_EV_DELETE_OWN] = "{A} ha scelto di eliminare '{C}' dalla sua aula.",
+		[LOG_EV_DELETE_OWN_NONE] = "{A} avrebbe dovuto eliminare una carta {K} dalla sua aula, ma non ne aveva.",
+		[LOG_EV_DELETE] = "{A} ha eliminato '{C}' dall'aula di {T}.",
+		[LOG_EV_DELETE_NONE] = "{A} avrebbe dovuto eliminare una carta {K} dall'aula di {T}, ma non ne aveva.",
+		[LOG_EV_ATTACK_DISCARD] = "{T} ha scartato {C} a causa dell'attacco di {A}.",
+		[LOG_EV_ATTACK_DISCARD_NONE] = "{T} doveva scartare una carta {K} a causa dell'attacco di {A}, ma non ne aveva.",
+		[LOG_EV_MUST_PLAY] = "{A} deve giocare una carta {K} grazie all'effetto {E}.",
+		[LOG_EV_FORCED_PLAY] = "{T} deve giocare una carta {K} grazie all'effetto {E} di {A}.",
+		[LOG_EV_PLAY_NONE] = "{T} avrebbe dovuto giocare una carta {K}, ma non ne aveva.",
+		[LOG_EV_STEAL] = "{A} ha rubato '{C}' a {T}.",
+		[LOG_EV_STEAL_NONE] = "{A} avrebbe dovuto rubare una carta {K} a {T}, ma non ne aveva.",
+		[LOG_EV_STEAL_HAND] = "{A} ha rubato '{C}' dalla mano di {T}.",
+		[LOG_EV_STEAL_HAND_NONE] = "{A} doveva rubare una carta {K} dalla mano di {T}, ma non ne aveva.",
+		[LOG_EV_MUST_DRAW] = "{A} deve pescare una carta {K} grazie all'effetto {E}.",
+		[LOG_EV_FORCED_DRAW] = "{T} deve pescare una carta {K} grazie all'effetto {E} di {A}.",
+		[LOG_EV_DRAW_MISMATCH] = "{T} avrebbe dovuto pescare una carta {K}, ma ha pescato '{C}' ({Y}), scartandola.",
+		[LOG_EV_SWAP_HANDS] = "{A} scambia il suo mazzo con quello di {T} grazie all'effetto {E}.",
+		[LOG_EV_WIN] = "{A} ha vinto la partita!",
+		[LOG_EV_ROUND_END] = "Fine del turno di {A} con {N} carte in mano."
+	};
+	return type < LOG_EV_COUNT ? mapping[type] : NULL;
+}
+
+/**
+ * @brief call this when the log file is truncated or not a log file. does not return.
+ * 
+ * @param path log file path
+ */
+void log_file_invalid(const char *path) {
+	fprintf(stderr, "Invalid or truncated log file (%s)!\n", path);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief reads the string declared by a dictionary record, stored in the following records
+ * 
+ * @param fp log file stream
+ * @param record dictionary record, its other_card field is the string length
+ * @param path log file path, for error messages
+ * @return char* heap-allocated string
+ */
+char *read_log_string(FILE *fp, log_recordT *record, const char *path) {
+	size_t len = record->other_card, n_records = (len + sizeof(log_recordT) - 1) / sizeof(log_recordT);
+	char *str = (char*)malloc_checked(n_records*sizeof(log_recordT) + 1);
+
+	if (fread(str, sizeof(log_recordT), n_records, fp) != n_records)
+		log_file_invalid(path);
+	str[len] = '\0';
+	return str;
+}
+
+/**
+ * @brief finds a card declared in the log
+ * 
+ * @param printer printer state
+ * @param id card id
+ * @return log_cardT* declared card or NULL if not found
+ */
+log_cardT *find_log_card(log_printerT *printer, unsigned int id) {
+	for (int i = 0; i < printer->n_cards; i++) {
+		if (printer->cards[i].id == id)
+			return &printer->cards[i];
+	}
+	return NULL;
+}
+
+/**
+ * @brief stores a card declared by a LOG_EV_CARD record (cards with the same id have the same name)
+ * 
+ * @param printer printer state
+ * @param record LOG_EV_CARD record
+ * @param name card name, ownership is taken
+ */
+void declare_log_card(log_printerT *printer, log_recordT *record, char *name) {
+	log_cardT *card = find_log_card(printer, record->card);
+
+	if (card == NULL) {
+		if (printer->n_cards == printer->cards_capacity) {
+			printer->cards_capacity = printer->cards_capacity == 0 ? LOG_PRINTER_MIN_CARDS : printer->cards_capacity*2;
+			printer->cards = (log_cardT*)realloc_checked(printer->cards, printer->cards_capacity*sizeof(log_cardT));
+		}
+		card = &printer->cards[printer->n_cards++];
+		card->id = record->card;
+	} else
+		free_wrap(card->name);
+
+	card->tipo = (tipo_cartaT)record->card_type;
+	card->quando = (quandoT)record->effect;
+	card->name = name;
+}
+
+/**
+ * @brief prints the name of the player sitting at a seat
+ * 
+ * @param printer printer state
+ * @param seat seat of the player
+ */
+void print_log_player(log_printerT *printer, unsigned char seat) {
+	fputs(seat < MAX_PLAYERS && printer->players[seat] != NULL ? printer->players[seat] : "?", stdout);
+}
+
+/**
+ * @brief prints the name of a card declared in the log, or its id if it wasn't declared
+ * 
+ * @param card declared card, can be NULL
+ * @param id card id
+ */
+void print_log_card(log_cardT *card, unsigned int id) {
+	if (card != NULL)
+		fputs(card->name, stdout);
+	else
+		printf("#%08x", id);
+}
+
+/**
+ * @brief prints an event record expanding the placeholders of its template
+ * 
+ * @param printer printer state
+ * @param record event record
+ */
+void print_log_event(log_printerT *printer, log_recordT *record) {
+	const char *text = log_template((log_event_typeT)record->type);
+	log_cardT *card = find_log_card(printer, record->card), *other_card = find_log_card(printer, record->other_card);
+
+	if (text == NULL)
+		text = "[Evento sconosciuto]";
+	else if (record->type >= LOG_EV_SAVE)
+		printf("[Turno %d] ", record->round_num);
+	for (; *text != '\0'; text++) {
+		if (text[0] == '{' && text[1] != '\0' && text[2] == '}') {
+			switch (text[1]) {
+				case 'A': print_log_player(printer, record->actor); break;
+				case 'T': print_log_player(printer, record->target); break;
+				case 'C': print_log_card(card, record->card); break;
+				case 'D': print_log_card(other_card, record->other_card); break;
+				case 'K': fputs(tipo_cartaT_str((tipo_cartaT)record->card_type), stdout); break;
+				case 'E': fputs(azioneT_str((azioneT)record->effect), stdout); break;
+				case 'F': {
+					printf("%s -> %s (%s)",
+						azioneT_str((azioneT)record->effect),
+						tipo_cartaT_str((tipo_cartaT)record->card_type),
+						target_giocatoriT_str((target_giocatoriT)record->effect_players)
+					);
+					break;
+				}
+				case 'Q': fputs(card != NULL ? quandoT_str(card->quando) : "?", stdout); break;
+				case 'Y': fputs(card != NULL ? tipo_cartaT_str(card->tipo) : "?", stdout); break;
+				case 'N': printf("%u", record->other_card); break;
+				case 'S': fputs(printer->save_path != NULL ? printer->save_path : "?", stdout); break;
+			}
+			text += 2;
+		} else
+			putchar(*text);
+	}
+	putchar('\n');
+}
+
+/**
+ * @brief reads every record of a log file, updating the dictionaries and printing events as text
+ * 
+ * @param printer printer state
+ * @param fp log file stream
+ * @param path log file path, for error messages
+ */
+void print_log(log_printerT *printer, FILE *fp, const char *path) {
+	log_recordT record;
+	char *str;
+
+	while (fread(&record, sizeof(log_recordT), ONE_ELEMENT, fp) == ONE_ELEMENT) {
+		if (record.type == LOG_EV_PLAYER || record.type == LOG_EV_CARD || record.type == LOG_EV_SAVE_PATH) {
+			str = read_log_string(fp, &record, path);
+			if (record.type == LOG_EV_PLAYER && record.actor < MAX_PLAYERS) {
+				free_wrap(printer->players[record.actor]);
+				printer->players[record.actor] = str;
+			} else if (record.type == LOG_EV_CARD)
+				declare_log_card(printer, &record, str);
+			else if (record.type == LOG_EV_SAVE_PATH) {
+				free_wrap(printer->save_path);
+				printer->save_path = str;
+			} else
+				free_wrap(str);
+		} else if (record.type == LOG_EV_START && (record.card != LOG_MAGIC || record.other_card != LOG_VERSION))
+			log_file_invalid(path);
+		else
+			print_log_event(printer, &record);
+	}
+}
+
+/**
+ * @brief frees the dictionaries of a printer
+ * 
+ * @param printer printer state
+ */
+void clear_log_printer(log_printerT *printer) {
+	for (int i = 0; i < MAX_PLAYERS; i++)
+		free_wrap(printer->players[i]);
+	for (int i = 0; i < printer->n_cards; i++)
+		free_wrap(printer->cards[i].name);
+	free_wrap(printer->cards);
+	free_wrap(printer->save_path);
+}
+
+/**
+ * @brief opens a log file, decompressing it first if it is a rotated segment compressed by the game (see
+ * compress_log_segment in files.c)
+ * 
+ * @param path log file path
+ * @return FILE* stream of the uncompressed records, NULL if the file can't be opened
+ */
+FILE *open_log_file(const char *path) {
+	unsigned char window[sizeof(log_recordT)] = { 0 }; // bytes of the previous record
+	unsigned int magic;
+	size_t pos = 0;
+	int byte, zeros;
+	FILE *fp = fopen(path, "rb"), *records;
+
+	if (fp == NULL)
+		return NULL;
+	if (fread(&magic, sizeof(magic), ONE_ELEMENT, fp) != ONE_ELEMENT || magic != LOG_COMPRESSED_MAGIC) {
+		rewind(fp);
+		return fp;
+	}
+
+	records = tmpfile();
+	if (records == NULL) {
+		fputs("Creating a temporary file failed!\n", stderr);
+		exit(EXIT_FAILURE);
+	}
+	while ((byte = getc(fp)) != EOF) {
+		zeros = 1; // a literal byte is a single byte of its own
+		if (byte == 0 && (zeros = getc(fp)) == EOF)
+			log_file_invalid(path);
+		for (int i = 0; i < zeros; i++) {
+			window[pos] ^= (unsigned char)byte; // undo the xor with the same byte of the previous record
+			putc(window[pos], records);
+			pos = (pos + 1) % sizeof(log_recordT);
+		}
+	}
+	fclose(fp);
+	rewind(records);
+	return records;
+}
+
+/**
+ * @brief log printer entry point: renders the binary log files written by the game as text on standard output
+ * 
+ * @param argc command line arguments count
+ * @param argv optional log file paths (FILE_LOG by default), compressed or not, oldest first (e.g. log.2.bin.rle
+ * log.1.bin log.bin)
+ * @return int exit code
+ */
+int main(int argc, const char *argv[]) {
+	const char *default_paths[] = { FILE_LOG };
+	const char **paths = argc > 1 ? &argv[1] : default_paths;
+	int n_paths = argc > 1 ? argc-1 : 1;
+	log_printerT printer = { 0 };
+	FILE *fp;
+
+	for (int i = 0; i < n_paths; i++) {
+		fp = open_log_file(paths[i]);
+		if (fp == NULL) {
+			fprintf(stderr, "Opening log file (%s) failed!\n", paths[i]);
+			return EXIT_FAILURE;
+		}
+		print_log(&printer, fp, paths[i]);
+		fclose(fp);
+	}
+
+	clear_log_printer(&printer);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,403 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "structs.h"
+#include "enums.h"
+#include "files.h"
+#include "utils.h"
+
+/**
+ * @brief returns the column (or key) suffix of the played cards of a card type
+ * 
+ * @param type card type
+ * @return const char* suffix
+ */
+const char *export_card_type_key(tipo_cartaT type) {
+	static const char *mapping[] = {
+		[ALL] = "all",
+		[STUDENTE] = "studente",
+		[MATRICOLA] = "matricola",
+		[STUDENTE_SEMPLICE] = "studente_semplice",
+		[LAUREANDO] = "laureando",
+		[BONUS] = "bonus",
+		[MALUS] = "malus",
+		[MAGIA] = "magia",
+		[ISTANTANEA] = "istantanea"
+	};
+	return mapping[type];
+}
+
+/**
+ * @brief prints that an exported file is invalid, then terminates
+ * 
+ * @param path file path
+ */
+void export_file_invalid(const char *path) {
+	fprintf(stderr, "File (%s) is invalid!\n", path);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief writes the buffered output and empties the buffer
+ * 
+ * @param buffer output buffer
+ */
+void export_flush(export_bufferT *buffer) {
+	if (fwrite(buffer->data, sizeof(char), buffer->len, buffer->out) != buffer->len) {
+		fprintf(stderr, "Writing the export failed!\n");
+		exit(EXIT_FAILURE);
+	}
+	buffer->len = 0;
+}
+
+/**
+ * @brief makes room for a row in the buffer, writing the buffered output if the row may not fit: rows are then
+ * appended without any bounds check
+ * 
+ * @param buffer output buffer
+ */
+void export_begin_row(export_bufferT *buffer) {
+	if (buffer->len + EXPORT_ROW_MAX > EXPORT_BUFFER_SIZE)
+		export_flush(buffer);
+}
+
+/**
+ * @brief appends a string as is
+ * 
+ * @param buffer output buffer
+ * @param str string
+ */
+void export_text(export_bufferT *buffer, const char *str) {
+	size_t len = strlen(str);
+	memcpy(&buffer->data[buffer->len], str, len);
+	buffer->len += len;
+}
+
+/**
+ * @brief appends an integer, formatted without printf (exporting millions of rows is mostly formatting integers)
+ * 
+ * @param buffer output buffer
+ * @param value integer
+ */
+void export_int(export_bufferT *buffer, long long value) {
+	char digits[24];
+	int n_digits = 0;
+	unsigned long long magnitude = value < 0 ? -(unsigned long long)value : (unsigned long long)value;
+
+	if (value < 0)
+		buffer->data[buffer->len++] = '-';
+	do {
+		digits[n_digits++] = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude > 0);
+	while (n_digits > 0)
+		buffer->data[buffer->len++] = digits[--n_digits];
+}
+
+/**
+ * @brief appends a player name as a quoted string: CSV doubles the quotes, JSON escapes quotes, backslashes and
+ * control characters. names are always NUL-terminated within GIOCATORE_NAME_LEN+1 bytes
+ * 
+ * @param buffer output buffer
+ * @param name player name
+ * @param json true for JSON, false for CSV
+ */
+void export_name(export_bufferT *buffer, const char *name, bool json) {
+	static const char hex[] = "0123456789abcdef";
+	unsigned char c;
+
+	buffer->data[buffer->len++] = '"';
+	for (int i = 0; i <= GIOCATORE_NAME_LEN && name[i] != '\0'; i++) {
+		c = (unsigned char)name[i];
+		if (c == '"')
+			export_text(buffer, json ? "\\\"" : "\"\"");
+		else if (json && c == '\\')
+			export_text(buffer, "\\\\");
+		else if (json && c < 0x20) {
+			export_text(buffer, "\\u00");
+			buffer->data[buffer->len++] = hex[c >> 4];
+			buffer->data[buffer->len++] = hex[c & 0xF];
+		} else
+			buffer->data[buffer->len++] = (char)c;
+	}
+	buffer->data[buffer->len++] = '"';
+}
+
+/**
+ * @brief appends a field: the separator (unless it's the first field of the row, or of a JSON object), then the JSON
+ * key if any
+ * 
+ * @param buffer output buffer
+ * @param key JSON key, NULL for CSV
+ * @param first true for the first field of the row (or JSON object)
+ */
+void export_field(export_bufferT *buffer, const char *key, bool first) {
+	if (!first)
+		buffer->data[buffer->len++] = ',';
+	if (key != NULL) {
+		buffer->data[buffer->len++] = '"';
+		export_text(buffer, key);
+		export_text(buffer, "\":");
+	}
+}
+
+/**
+ * @brief appends the played cards by type: as columns for CSV, as a "played_cards" object for JSON
+ * 
+ * @param buffer output buffer
+ * @param played_cards played cards of each type
+ * @param json true for JSON, false for CSV
+ */
+void export_played_cards(export_bufferT *buffer, const int played_cards[CARDS_TYPE_COUNT], bool json) {
+	if (json)
+		export_text(buffer, ",\"played_cards\":{");
+	for (tipo_cartaT type = ALL; type <= ISTANTANEA; type++) {
+		export_field(buffer, json ? export_card_type_key(type) : NULL, json && type == ALL);
+		export_int(buffer, played_cards[type]);
+	}
+	if (json)
+		buffer->data[buffer->len++] = '}';
+}
+
+/**
+ * @brief appends the CSV header of the played cards columns
+ * 
+ * @param buffer output buffer
+ * @param seat seat of the columns (1-based), 0 for the columns of the stats file
+ */
+void export_played_cards_header(export_bufferT *buffer, int seat) {
+	for (tipo_cartaT type = ALL; type <= ISTANTANEA; type++) {
+		export_text(buffer, ",played_");
+		export_text(buffer, export_card_type_key(type));
+		if (seat > 0) {
+			buffer->data[buffer->len++] = '_';
+			export_int(buffer, seat);
+		}
+	}
+}
+
+/**
+ * @brief takes the snapshot of a file for exporting: its records are counted and copied into a temporary file while
+ * holding a shared lock for the whole copy, so that the export is consistent (no game or stats_merge rewrites or
+ * appends a record meanwhile) and records appended after the snapshot (or partially written) by a running game are
+ * not exported. the lock only blocks writers, and only for the sequential copy, never while the export is written out
+ * 
+ * @param path file path
+ * @param header_size bytes before the first record
+ * @param record_size bytes of a record
+ * @param n_records records of the snapshot (out parameter)
+ * @return FILE* stream of the snapshot positioned on the header
+ */
+FILE *open_export_snapshot(const char *path, long header_size, long record_size, long *n_records) {
+	FILE *fp = fopen(path, "rb"), *snapshot;
+	char *chunk;
+	long size;
+	size_t n_chunk;
+
+	if (fp == NULL) {
+		fprintf(stderr, "Opening file (%s) failed!\n", path);
+		exit(EXIT_FAILURE);
+	}
+	snapshot = tmpfile();
+	if (snapshot == NULL) {
+		fprintf(stderr, "Creating the snapshot of file (%s) failed!\n", path);
+		exit(EXIT_FAILURE);
+	}
+
+	chunk = (char*)malloc_checked(EXPORT_BATCH * record_size);
+	lock_file(fp, FILE_LOCK_READ);
+	if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < header_size || fseek(fp, 0, SEEK_SET) != 0)
+		export_file_invalid(path);
+	*n_records = (size - header_size) / record_size;
+	for (long left = header_size + *n_records * record_size; left > 0; left -= (long)n_chunk) {
+		n_chunk = left < EXPORT_BATCH * record_size ? (size_t)left : (size_t)(EXPORT_BATCH * record_size);
+		if (fread(chunk, sizeof(char), n_chunk, fp) != n_chunk)
+			export_file_invalid(path);
+		if (fwrite(chunk, sizeof(char), n_chunk, snapshot) != n_chunk) {
+			fprintf(stderr, "Creating the snapshot of file (%s) failed!\n", path);
+			exit(EXIT_FAILURE);
+		}
+	}
+	lock_file(fp, FILE_UNLOCK);
+	fclose(fp);
+	free_wrap(chunk);
+
+	if (fflush(snapshot) != 0 || fseek(snapshot, 0, SEEK_SET) != 0) {
+		fprintf(stderr, "Creating the snapshot of file (%s) failed!\n", path);
+		exit(EXIT_FAILURE);
+	}
+	return snapshot;
+}
+
+/**
+ * @brief streams the stats of every player, one row each
+ * 
+ * @param buffer output buffer
+ * @param path stats file path
+ * @param json true for JSON Lines, false for CSV
+ */
+void export_stats(export_bufferT *buffer, const char *path, bool json) {
+	player_statsT *batch = (player_statsT*)malloc_checked(EXPORT_BATCH * sizeof(player_statsT));
+	long n_records;
+	FILE *fp = open_export_snapshot(path, 0, sizeof(player_statsT), &n_records);
+	size_t n_read;
+
+	if (!json) {
+		export_text(buffer, "name,wins,rounds,discarded");
+		export_played_cards_header(buffer, 0);
+		buffer->data[buffer->len++] = '\n';
+	}
+	for (long left = n_records; left > 0; left -= (long)n_read) {
+		n_read = fread(batch, sizeof(player_statsT), left < EXPORT_BATCH ? (size_t)left : EXPORT_BATCH, fp);
+		if (n_read == 0)
+			export_file_invalid(path);
+		for (size_t i = 0; i < n_read; i++) {
+			export_begin_row(buffer);
+			if (json)
+				buffer->data[buffer->len++] = '{';
+			export_field(buffer, json ? "name" : NULL, true);
+			export_name(buffer, batch[i].name, json);
+			export_field(buffer, json ? "wins" : NULL, false);
+			export_int(buffer, batch[i].wins);
+			export_field(buffer, json ? "rounds" : NULL, false);
+			export_int(buffer, batch[i].rounds);
+			export_field(buffer, json ? "discarded" : NULL, false);
+			export_int(buffer, batch[i].discarded);
+			export_played_cards(buffer, batch[i].played_cards, json);
+			export_text(buffer, json ? "}\n" : "\n");
+		}
+	}
+
+	fclose(fp);
+	free_wrap(batch);
+}
+
+/**
+ * @brief appends a game record as a row. CSV has columns for MAX_PLAYERS seats, left empty for missing players
+ * 
+ * @param buffer output buffer
+ * @param record game record
+ * @param json true for JSON Lines, false for CSV
+ */
+void export_game_record(export_bufferT *buffer, const game_recordT *record, bool json) {
+	int played_cards[CARDS_TYPE_COUNT];
+
+	export_begin_row(buffer);
+	if (json)
+		buffer->data[buffer->len++] = '{';
+	export_field(buffer, json ? "finished" : NULL, true);
+	export_int(buffer, record->finished);
+	export_field(buffer, json ? "seed" : NULL, false);
+	export_int(buffer, record->seed);
+	export_field(buffer, json ? "duration" : NULL, false);
+	export_int(buffer, record->duration);
+	export_field(buffer, json ? "rounds" : NULL, false);
+	export_int(buffer, record->rounds);
+	export_field(buffer, json ? "n_players" : NULL, false);
+	export_int(buffer, record->n_players);
+	export_field(buffer, json ? "winner_seat" : NULL, false);
+	export_int(buffer, record->winner+1);
+	export_field(buffer, json ? "players" : NULL, false);
+	if (json)
+		buffer->data[buffer->len++] = '[';
+
+	for (int seat = 0; seat < (json ? record->n_players : MAX_PLAYERS); seat++) {
+		if (json)
+			export_text(buffer, seat == 0 ? "{\"name\":" : ",{\"name\":");
+		if (seat < record->n_players) {
+			for (int type = 0; type < CARDS_TYPE_COUNT; type++)
+				played_cards[type] = record->played_cards[seat][type];
+			export_name(buffer, record->names[seat], json);
+			export_played_cards(buffer, played_cards, json);
+		} else {
+			for (int type = 0; type < CARDS_TYPE_COUNT; type++)
+				buffer->data[buffer->len++] = ',';
+		}
+		if (json)
+			buffer->data[buffer->len++] = '}';
+		else if (seat < MAX_PLAYERS-1)
+			buffer->data[buffer->len++] = ',';
+	}
+	export_text(buffer, json ? "]}\n" : "\n");
+}
+
+/**
+ * @brief streams the history of the finished games, one row each (records with invalid players are skipped)
+ * 
+ * @param buffer output buffer
+ * @param path history file path
+ * @param json true for JSON Lines, false for CSV
+ */
+void export_history(export_bufferT *buffer, const char *path, bool json) {
+	game_recordT *batch = (game_recordT*)malloc_checked(EXPORT_BATCH * sizeof(game_recordT));
+	history_headerT header;
+	long n_records, skipped = 0;
+	FILE *fp = open_export_snapshot(path, sizeof(history_headerT), sizeof(game_recordT), &n_records);
+	size_t n_read;
+
+	if (fread(&header, sizeof(history_headerT), ONE_ELEMENT, fp) != ONE_ELEMENT || header.magic != HISTORY_MAGIC ||
+		header.version != HISTORY_VERSION || header.record_size != (int)sizeof(game_recordT))
+		export_file_invalid(path);
+	if (!json) {
+		export_text(buffer, "finished,seed,duration,rounds,n_players,winner_seat,");
+		for (int seat = 1; seat <= MAX_PLAYERS; seat++) {
+			export_text(buffer, seat == 1 ? "name_" : ",name_");
+			export_int(buffer, seat);
+			export_played_cards_header(buffer, seat);
+		}
+		buffer->data[buffer->len++] = '\n';
+	}
+	for (long left = n_records; left > 0; left -= (long)n_read) {
+		n_read = fread(batch, sizeof(game_recordT), left < EXPORT_BATCH ? (size_t)left : EXPORT_BATCH, fp);
+		if (n_read == 0)
+			export_file_invalid(path);
+		for (size_t i = 0; i < n_read; i++) {
+			if (batch[i].n_players >= 1 && batch[i].n_players <= MAX_PLAYERS && batch[i].winner < batch[i].n_players)
+				export_game_record(buffer, &batch[i], json);
+			else
+				skipped++;
+		}
+	}
+	if (skipped > 0)
+		fprintf(stderr, "%ld invalid game records skipped\n", skipped);
+
+	fclose(fp);
+	free_wrap(batch);
+}
+
+/**
+ * @brief exports the stats file or the history as CSV or JSON Lines to the standard output:
+ * stats_export <stats|storico> [csv|jsonl] [file]
+ * 
+ * @param argc arguments count
+ * @param argv arguments
+ * @return int exit status
+ */
+int main(int argc, const char *argv[]) {
+	export_bufferT *buffer;
+	bool history, json;
+
+	if (argc < 2 || (strcmp(argv[1], "stats") && strcmp(argv[1], "storico")) ||
+		(argc > 2 && strcmp(argv[2], "csv") && strcmp(argv[2], "jsonl"))) {
+		fprintf(stderr, "Usage: %s <stats|storico> [csv|jsonl] [file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	history = !strcmp(argv[1], "storico");
+	json = argc > 2 && !strcmp(argv[2], "jsonl");
+
+	buffer = (export_bufferT*)malloc_checked(sizeof(export_bufferT));
+	buffer->out = stdout;
+	buffer->len = 0;
+	if (history)
+		export_history(buffer, argc > 3 ? argv[3] : FILE_HISTORY, json);
+	else
+		export_stats(buffer, argc > 3 ? argv[3] : FILE_STATS, json);
+	export_flush(buffer);
+	if (fflush(stdout) != 0) {
+		fprintf(stderr, "Writing the export failed!\n");
+		return EXIT_FAILURE;
+	}
+
+	free_wrap(buffer);
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
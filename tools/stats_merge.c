@@ -0,0 +1,264 @@
+#define _POSIX_C_SOURCE 200809L // fileno, ftruncate, fstat
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "structs.h"
+#include "files.h"
+#include "stats.h"
+#include "utils.h"
+
+/**
+ * @brief returns the slot of a player in the merge table, or the empty slot where it should be inserted
+ * 
+ * @param table merge table
+ * @param name player name
+ * @return int slot
+ */
+int find_merge_slot(stats_merge_tableT *table, const char *name) {
+	int slot = hash_string(name) & (table->n_slots-1);
+
+	while (table->slots[slot] != 0 && strncmp(table->entries[table->slots[slot]-1].name, name, GIOCATORE_NAME_LEN))
+		slot = (slot+1) & (table->n_slots-1); // linear probing
+	return slot;
+}
+
+/**
+ * @brief doubles the slots of the merge table, inserting every entry again
+ * 
+ * @param table merge table
+ */
+void grow_merge_table(stats_merge_tableT *table) {
+	free_wrap(table->slots);
+	table->n_slots *= 2;
+	table->slots = (int*)calloc_checked(table->n_slots, sizeof(int));
+	for (int entry = 0; entry < table->n_entries; entry++)
+		table->slots[find_merge_slot(table, table->entries[entry].name)] = entry+1;
+}
+
+/**
+ * @brief adds the stats of a player read from a shard to the merge table
+ * 
+ * @param table merge table
+ * @param stats player stats
+ */
+void add_merge_entry(stats_merge_tableT *table, player_statsT *stats) {
+	int slot;
+
+	stats->name[GIOCATORE_NAME_LEN] = '\0';
+	slot = find_merge_slot(table, stats->name);
+	if (table->slots[slot] != 0) {
+		add_player_stats(&table->entries[table->slots[slot]-1], stats);
+		return;
+	}
+
+	if (table->n_entries == table->capacity) {
+		table->capacity = table->capacity > 0 ? table->capacity*2 : MERGE_BATCH;
+		table->entries = (player_statsT*)realloc_checked(table->entries, table->capacity * sizeof(player_statsT));
+	}
+	table->entries[table->n_entries] = *stats;
+	table->entries[table->n_entries].next = NULL;
+	table->slots[slot] = ++table->n_entries;
+	if (2*table->n_entries > table->n_slots)
+		grow_merge_table(table);
+}
+
+/**
+ * @brief checks if two files are the same one, whatever the paths they were opened with (hard links included)
+ * 
+ * @param file status of the first file
+ * @param other status of the second file
+ * @return true if they are the same file
+ * @return false if they are different files (always on Windows, where there are no inode numbers)
+ */
+bool same_file(const struct stat *file, const struct stat *other) {
+#ifndef _WIN32
+	return file->st_dev == other->st_dev && file->st_ino == other->st_ino;
+#else
+	(void)file;
+	(void)other;
+	return false;
+#endif
+}
+
+/**
+ * @brief reads every record of a stats shard into the merge table. the shard is left open holding its exclusive lock,
+ * so that a worker can't save into it (or be halfway through saving) until the shard has been merged and emptied.
+ * fcntl locks belong to the process, so locking a file it already locked would not block: the shard is rejected before
+ * locking it if it's the stats file or a shard given before, which would be counted twice (and emptied)
+ * 
+ * @param table merge table
+ * @param path shard path
+ * @param files status of the stats file followed by the shards, the one of this shard is filled (in/out parameter)
+ * @param shard number of the shard, starting from 1
+ * @return FILE* locked shard stream
+ */
+FILE *read_stats_shard(stats_merge_tableT *table, const char *path, struct stat *files, int shard) {
+	player_statsT *batch;
+	FILE *fp = fopen(path, "rb+"); // open binary file for reading and writing, to lock it exclusively
+	size_t n_read;
+
+	if (fp == NULL || fstat(fileno(fp), &files[shard]) != 0) {
+		fprintf(stderr, "Opening stats shard (%s) failed!\n", path);
+		exit(EXIT_FAILURE);
+	}
+	for (int i = 0; i < shard; i++) {
+		if (same_file(&files[i], &files[shard])) {
+			if (i == 0)
+				fprintf(stderr, "Stats shard (%s) is the stats file (%s), it can't be merged into itself!\n", path, FILE_STATS);
+			else
+				fprintf(stderr, "Stats shard (%s) was already given, it can't be merged twice!\n", path);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	batch = (player_statsT*)malloc_checked(MERGE_BATCH * sizeof(player_statsT));
+	lock_file(fp, FILE_LOCK_WRITE);
+	while ((n_read = fread(batch, sizeof(player_statsT), MERGE_BATCH, fp)) > 0) {
+		for (size_t i = 0; i < n_read; i++)
+			add_merge_entry(table, &batch[i]);
+	}
+	if (ferror(fp)) {
+		fprintf(stderr, "Reading stats shard (%s) failed!\n", path);
+		exit(EXIT_FAILURE);
+	}
+
+	free_wrap(batch);
+	return fp;
+}
+
+/**
+ * @brief folds the merge table into the stats file with one sequential pass: each batch of records is read, the
+ * players found in the table are updated and the batch is written back in place
+ * 
+ * @param store stats store opened for writing
+ * @param table merge table
+ * @return int records of the stats file updated
+ */
+int merge_stats_records(stats_storeT *store, stats_merge_tableT *table) {
+	player_statsT *batch = (player_statsT*)malloc_checked(MERGE_BATCH * sizeof(player_statsT));
+	int n_batch, slot, updated = 0;
+
+	for (int first = 0; first < store->header.n_records; first += n_batch) {
+		n_batch = store->header.n_records - first < MERGE_BATCH ? store->header.n_records - first : MERGE_BATCH;
+		if (fseek(store->records, (long)first*sizeof(player_statsT), SEEK_SET) != 0 ||
+			fread(batch, sizeof(player_statsT), n_batch, store->records) != (size_t)n_batch) {
+			fprintf(stderr, "Reading stats file (%s) failed!\n", FILE_STATS);
+			exit(EXIT_FAILURE);
+		}
+		for (int i = 0; i < n_batch; i++) {
+			slot = find_merge_slot(table, batch[i].name);
+			if (table->slots[slot] != 0) {
+				add_player_stats(&batch[i], &table->entries[table->slots[slot]-1]);
+				table->merged[table->slots[slot]-1] = true;
+				updated++;
+			}
+		}
+		if (fseek(store->records, (long)first*sizeof(player_statsT), SEEK_SET) != 0 ||
+			fwrite(batch, sizeof(player_statsT), n_batch, store->records) != (size_t)n_batch) {
+			fprintf(stderr, "Writing stats file (%s) failed!\n", FILE_STATS);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	free_wrap(batch);
+	return updated;
+}
+
+/**
+ * @brief appends to the stats file the players of the merge table who weren't in it yet
+ * 
+ * @param store stats store opened for writing
+ * @param table merge table
+ * @return int records appended
+ */
+int append_stats_records(stats_storeT *store, stats_merge_tableT *table) {
+	int appended = 0;
+
+	if (fseek(store->records, (long)store->header.n_records*sizeof(player_statsT), SEEK_SET) != 0) {
+		fprintf(stderr, "Writing stats file (%s) failed!\n", FILE_STATS);
+		exit(EXIT_FAILURE);
+	}
+	for (int entry = 0; entry < table->n_entries; entry++) {
+		if (!table->merged[entry]) {
+			if (fwrite(&table->entries[entry], sizeof(player_statsT), ONE_ELEMENT, store->records) != ONE_ELEMENT) {
+				fprintf(stderr, "Writing stats file (%s) failed!\n", FILE_STATS);
+				exit(EXIT_FAILURE);
+			}
+			appended++;
+		}
+	}
+	store->header.n_records += appended;
+	return appended;
+}
+
+/**
+ * @brief merges stats shards (stats files written by games running in their own directories, e.g. parallel workers)
+ * into the stats file of the current directory, then empties them: stats_merge <shard> [shard...].
+ * shards are emptied only after the stats file has been written, so if the merge is interrupted in between, running it
+ * again would count them twice: the stats file must be restored from a backup first
+ * 
+ * @param argc arguments count
+ * @param argv arguments
+ * @return int exit status
+ */
+int main(int argc, const char *argv[]) {
+	stats_merge_tableT table = { .n_slots = MERGE_MIN_SLOTS };
+	stats_storeT store;
+	FILE **shards;
+	struct stat *files;
+	int updated, appended;
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <shard> [shard...]\n"
+			"Shards are emptied after being merged. If the merge is interrupted before the end, restore the stats file (%s)\n"
+			"from a backup before merging them again, or they would be counted twice.\n", argv[0], FILE_STATS);
+		return EXIT_FAILURE;
+	}
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], FILE_STATS)) {
+			fprintf(stderr, "The stats file (%s) can't be merged into itself!\n", FILE_STATS);
+			return EXIT_FAILURE;
+		}
+	}
+
+	fclose(open_stats_read()); // create the stats file if it doesn't exist, so that shards can be compared with it
+	files = (struct stat*)malloc_checked(argc * sizeof(struct stat));
+	if (stat(FILE_STATS, &files[0]) != 0) {
+		fprintf(stderr, "Opening stats file (%s) failed!\n", FILE_STATS);
+		return EXIT_FAILURE;
+	}
+
+	// shards are summed in memory first, so that the stats file is locked only for its sequential pass
+	table.slots = (int*)calloc_checked(table.n_slots, sizeof(int));
+	shards = (FILE**)malloc_checked((argc-1) * sizeof(FILE*));
+	for (int i = 1; i < argc; i++)
+		shards[i-1] = read_stats_shard(&table, argv[i], files, i);
+	table.merged = (bool*)calloc_checked(table.n_entries > 0 ? table.n_entries : 1, sizeof(bool));
+
+	open_stats_store(&store, true);
+	updated = merge_stats_records(&store, &table);
+	appended = append_stats_records(&store, &table);
+	if (fflush(store.records) != 0) {
+		fprintf(stderr, "Writing stats file (%s) failed!\n", FILE_STATS);
+		return EXIT_FAILURE;
+	}
+	rebuild_stats_index(&store); // records changed and were appended without going through the index
+	close_stats_store(&store);
+
+	// still holding the shard locks: stats saved by workers meanwhile were waiting for them, and go into the emptied shards
+	for (int i = 1; i < argc; i++) {
+		if (ftruncate(fileno(shards[i-1]), 0) != 0)
+			fprintf(stderr, "Emptying stats shard (%s) failed, it must not be merged again!\n", argv[i]);
+		fclose(shards[i-1]);
+	}
+	printf("Statistiche di %d shard unite: %d giocatori aggiornati, %d nuovi giocatori.\n", argc-1, updated, appended);
+
+	free_wrap(shards);
+	free_wrap(files);
+	free_wrap(table.entries);
+	free_wrap(table.merged);
+	free_wrap(table.slots);
+	return EXIT_SUCCESS;
+}
\ No newline at end of file